@@ -0,0 +1,57 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "set.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+template <class A>
+void bench(std::vector<int> const& v)
+{
+  using timer_t = std::chrono::high_resolution_clock;
+
+  xsg::set<int, std::compare_three_way, std::allocator<int>, A> s;
+
+  auto t0(timer_t::now());
+
+  for (auto const k: v) s.insert(k);
+
+  auto const ti(std::chrono::nanoseconds(timer_t::now() - t0).count());
+
+  std::size_t c{};
+  t0 = timer_t::now();
+
+  for (auto const k: v) c += s.contains(k);
+
+  auto const tf(std::chrono::nanoseconds(timer_t::now() - t0).count());
+
+  std::cout << A::num << '/' << A::den <<
+    "\tinsert: " << ti / v.size() << " ns" <<
+    "\tfind: " << tf / v.size() << " ns" <<
+    "\theight: " << xsg::detail::height(s.root(), {}) <<
+    "\tfound: " << c << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+int main()
+{
+  std::vector<int> v(1000000);
+
+  {
+    std::mt19937 g;
+    std::uniform_int_distribution<int> d;
+
+    for (auto& k: v) k = d(g);
+  }
+
+  // tighter alpha: shallower trees and faster lookups, but more rebuilds
+  bench<std::ratio<11, 20>>(v);
+  bench<std::ratio<3, 5>>(v);
+  bench<std::ratio<2, 3>>(v);
+  bench<std::ratio<3, 4>>(v);
+  bench<std::ratio<4, 5>>(v);
+  bench<std::ratio<9, 10>>(v);
+
+  return 0;
+}
@@ -0,0 +1,369 @@
+#ifndef XSG_BUFFERED_HPP
+# define XSG_BUFFERED_HPP
+# pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace xsg
+{
+
+template <class C, detail::size_type N = 256>
+class buffered
+{ // stages insertions into a small sorted array, in front of the container
+  // C, the array is merged into C with a batch merge, once it fills, while
+  // lookups and iterators see both; staged values, whose keys C already
+  // holds, are dropped by the merge, as by C's emplace()
+public:
+  using container_type = C;
+
+  using key_type = typename C::key_type;
+  using value_type = typename C::value_type;
+
+  using difference_type = detail::difference_type;
+  using size_type = detail::size_type;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+
+private:
+  static constexpr bool multi{requires(typename C::node& n){ n.v_; }};
+
+  C c_;
+  std::vector<value_type> v_; // staged values, in emplacement order
+  std::vector<size_type> p_; // their indices, in key order
+
+  static auto& key(auto& v) noexcept
+  {
+    if constexpr(std::is_same_v<key_type, value_type>) return v;
+    else return std::get<0>(v);
+  }
+
+  static auto cmp(auto const& a, auto const& b) noexcept
+  {
+    return C::node::cmp(a, b);
+  }
+
+  auto& staged(size_type const j) const noexcept { return v_[p_[j]]; }
+
+  size_type lower_index(auto const& k) const noexcept
+  {
+    return std::partition_point(p_.begin(), p_.end(),
+        [&](auto const i) noexcept { return cmp(key(v_[i]), k) < 0; }
+      ) - p_.begin();
+  }
+
+  size_type upper_index(auto const& k) const noexcept
+  {
+    return std::partition_point(p_.begin(), p_.end(),
+        [&](auto const i) noexcept { return cmp(key(v_[i]), k) <= 0; }
+      ) - p_.begin();
+  }
+
+  template <class B>
+  class bufferediterator
+  { // merges the container's and the staged sequences, the container's
+    // value comes first among equal keys
+    friend class buffered;
+
+    using tree_iterator = decltype(std::declval<B&>().c_.begin());
+
+    B* b_;
+    tree_iterator t_;
+    size_type j_; // the next staged value
+
+    bufferediterator(B* const b, tree_iterator const t,
+      size_type const j) noexcept:
+      b_(b),
+      t_(t),
+      j_(j)
+    {
+    }
+
+    bool tree() const noexcept
+    {
+      return (b_->p_.size() == j_) || ((b_->c_.end() != t_) &&
+        (cmp(key(*t_), key(b_->staged(j_))) <= 0));
+    }
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = detail::difference_type;
+    using value_type = std::remove_reference_t<decltype(*t_)>;
+
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    bufferediterator() = default;
+
+    bool operator==(bufferediterator const& o) const noexcept
+    {
+      return (t_ == o.t_) && (j_ == o.j_);
+    }
+
+    // increment, decrement
+    auto& operator++() noexcept
+    {
+      if (tree())
+      {
+        if constexpr(!multi)
+        { // skip a staged duplicate
+          if ((b_->p_.size() != j_) &&
+            (cmp(key(*t_), key(b_->staged(j_))) == 0)) ++j_;
+        }
+
+        ++t_;
+      }
+      else
+      {
+        ++j_;
+      }
+
+      return *this;
+    }
+
+    auto& operator--() noexcept
+    {
+      if (b_->c_.begin() == t_)
+      {
+        --j_;
+      }
+      else if (j_)
+      {
+        auto const c(cmp(key(*std::prev(t_)), key(b_->staged(j_ - 1))));
+
+        if ((c < 0) || (multi && (c == 0)))
+        {
+          --j_;
+        }
+        else
+        {
+          if (!multi && (c == 0)) --j_;
+
+          --t_;
+        }
+      }
+      else
+      {
+        --t_;
+      }
+
+      return *this;
+    }
+
+    auto operator++(int) noexcept { auto const r(*this); ++*this; return r; }
+    auto operator--(int) noexcept { auto const r(*this); --*this; return r; }
+
+    // member access
+    auto operator->() const noexcept { return &**this; }
+
+    reference operator*() const noexcept
+    {
+      return tree() ? *t_ : b_->v_[b_->p_[j_]];
+    }
+  };
+
+public:
+  using iterator = bufferediterator<buffered>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_iterator = bufferediterator<buffered const>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  buffered() = default;
+
+  buffered(buffered const&) = default;
+  buffered(buffered&&) = default;
+
+  buffered(std::initializer_list<value_type> const l)
+    requires(std::is_copy_constructible_v<value_type>): c_(l)
+  {
+  }
+
+  //
+  buffered& operator=(buffered const&) = default;
+  buffered& operator=(buffered&&) = default;
+
+  // iterators
+  iterator begin() noexcept { return {this, c_.begin(), {}}; }
+  iterator end() noexcept { return {this, c_.end(), p_.size()}; }
+
+  const_iterator begin() const noexcept { return {this, c_.begin(), {}}; }
+  const_iterator end() const noexcept
+  {
+    return {this, c_.end(), p_.size()};
+  }
+
+  auto cbegin() const noexcept { return begin(); }
+  auto cend() const noexcept { return end(); }
+
+  // reverse iterators
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  auto crbegin() const noexcept { return rbegin(); }
+  auto crend() const noexcept { return rend(); }
+
+  //
+  void clear() noexcept { c_.clear(); p_.clear(); v_.clear(); }
+  bool empty() const noexcept { return c_.empty() && p_.empty(); }
+
+  size_type size() const noexcept
+  { // O(N log n), while staged values may duplicate keys of the container
+    if constexpr(multi)
+    {
+      return c_.size() + p_.size();
+    }
+    else
+    {
+      return c_.size() + std::ranges::count_if(p_,
+          [&](auto const i) noexcept { return !c_.contains(key(v_[i])); }
+        );
+    }
+  }
+
+  //
+  auto& container() noexcept(noexcept(flush()))
+  { // the container, with the staged values merged in
+    flush(); return c_;
+  }
+
+  void flush() noexcept(noexcept(
+      c_.insert_batch_sorted(v_.begin(), v_.end())
+    )
+  )
+  { // merge the staged values into the container, the values that did
+    // not make it in stay staged, should the merge throw
+    if (!p_.empty())
+    {
+      auto const r(p_ | std::views::transform(
+          [&](auto const i) noexcept -> auto&& { return std::move(v_[i]); }
+        )
+      );
+
+      [[maybe_unused]] auto const sz(c_.size());
+
+      try
+      {
+        c_.insert_batch_sorted(r.begin(), r.end());
+      }
+      catch (...)
+      { // the merge consumes values in key order, unstage the consumed
+        // prefix, its moved-from values stay in v_ until the next flush
+        if constexpr(multi)
+        {
+          p_.erase(p_.begin(), p_.begin() + (c_.size() - sz));
+        }
+        else
+        {
+          p_.erase(p_.begin(), std::ranges::find_if(p_,
+              [&](auto const i) noexcept { return !c_.contains(key(v_[i])); }
+            )
+          );
+        }
+
+        if (p_.empty()) v_.clear();
+
+        throw;
+      }
+
+      p_.clear(); v_.clear();
+    }
+  }
+
+  //
+  bool contains(auto const& k) const noexcept
+  {
+    auto const j(lower_index(k));
+
+    return ((p_.size() != j) && (cmp(key(staged(j)), k) == 0)) ||
+      c_.contains(k);
+  }
+
+  //
+  void emplace(auto&& ...a)
+  { // staging costs O(N), in place of a descent
+    if (!v_.capacity()) v_.reserve(N), p_.reserve(N);
+
+    auto const& k(key(v_.emplace_back(std::forward<decltype(a)>(a)...)));
+    auto const j(upper_index(k));
+
+    if constexpr(!multi)
+    { // the earlier staged value wins
+      if (j && (cmp(key(staged(j - 1)), k) == 0))
+      {
+        v_.pop_back();
+
+        return;
+      }
+    }
+
+    p_.insert(p_.begin() + j, v_.size() - 1);
+
+    if (N <= p_.size()) flush();
+  }
+
+  void insert(value_type const& v) { emplace(v); }
+  void insert(value_type&& v) { emplace(std::move(v)); }
+
+  //
+  auto erase(auto const& k)
+  {
+    flush(); return c_.erase(k);
+  }
+
+  //
+  iterator find(auto const& k) noexcept
+  {
+    iterator const i(lower_bound(k));
+
+    return (end() == i) || (cmp(key(*i), k) != 0) ? end() : i;
+  }
+
+  const_iterator find(auto const& k) const noexcept
+  {
+    const_iterator const i(lower_bound(k));
+
+    return (end() == i) || (cmp(key(*i), k) != 0) ? end() : i;
+  }
+
+  //
+  iterator lower_bound(auto const& k) noexcept
+  {
+    return {this, c_.lower_bound(k), lower_index(k)};
+  }
+
+  const_iterator lower_bound(auto const& k) const noexcept
+  {
+    return {this, c_.lower_bound(k), lower_index(k)};
+  }
+
+  iterator upper_bound(auto const& k) noexcept
+  {
+    return {this, c_.upper_bound(k), upper_index(k)};
+  }
+
+  const_iterator upper_bound(auto const& k) const noexcept
+  {
+    return {this, c_.upper_bound(k), upper_index(k)};
+  }
+};
+
+}
+
+#endif // XSG_BUFFERED_HPP
@@ -1,22 +1,22 @@
 // iterators
 iterator begin() noexcept
 {
-  return root_ ?
-    iterator(&root_, detail::first_node(root_, {})) :
-    iterator(&root_);
+  return first_ ?
+    live(iterator(&last_, detail::first_pair(first_))) :
+    iterator(&last_);
 }
 
-iterator end() noexcept { return iterator(&root_); }
+iterator end() noexcept { return iterator(&last_); }
 
 // const iterators
 const_iterator begin() const noexcept
 {
-  return root_ ?
-    const_iterator(&root_, detail::first_node(root_, {})) :
-    const_iterator(&root_);
+  return first_ ?
+    live(const_iterator(&last_, detail::first_pair(first_))) :
+    const_iterator(&last_);
 }
 
-const_iterator end() const noexcept { return const_iterator(&root_); }
+const_iterator end() const noexcept { return const_iterator(&last_); }
 
 auto cbegin() const noexcept { return begin(); }
 auto cend() const noexcept { return end(); }
@@ -24,29 +24,20 @@ auto cend() const noexcept { return end(); }
 // reverse iterators
 reverse_iterator rbegin() noexcept
 {
-  return reverse_iterator(iterator(&root_));
+  return reverse_iterator(iterator(&last_));
 }
 
-reverse_iterator rend() noexcept
-{
-  return root_ ?
-    reverse_iterator(iterator(&root_, detail::first_node(root_, {}))) :
-    reverse_iterator(iterator(&root_));
-}
+reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
 
 // const reverse iterators
 const_reverse_iterator rbegin() const noexcept
 {
-  return const_reverse_iterator(const_iterator(&root_));
+  return const_reverse_iterator(const_iterator(&last_));
 }
 
 const_reverse_iterator rend() const noexcept
 {
-  return root_ ?
-    const_reverse_iterator(
-      const_iterator(&root_, detail::first_node(root_, {}))
-    ) :
-    const_reverse_iterator(const_iterator(&root_));
+  return const_reverse_iterator(begin());
 }
 
 auto crbegin() const noexcept { return rbegin(); }
@@ -54,19 +45,53 @@ auto crend() const noexcept { return rend(); }
 
 // self-assign neglected
 auto& operator=(this_class const& o)
-  noexcept(noexcept(clear(), insert(o.begin(), o.end())))
+  noexcept(noexcept(detail::clone(na_, o.root_, {}, {})))
   requires(std::is_copy_constructible_v<value_type>)
-{
-  if (this != &o) clear(), insert(o.begin(), o.end());
+{ // copy the tree structurally, without comparisons
+  if (this != &o)
+  {
+    clear();
+
+    if (o.sb_.t_) [[unlikely]]
+    { // the tombstones stay behind
+      insert_sorted(o.begin(), o.end()); return *this;
+    }
+
+    root_ = detail::clone(na_, o.root_, {}, {}); ms_ = o.ms_;
+    reset_ends();
+
+    if constexpr(requires{ this->vc_; }) this->vc_ = o.vc_;
+  }
 
   return *this;
 }
 
-auto& operator=(this_class&& o)
-  noexcept(noexcept(detail::destroy(root_, {})))
+auto& operator=(this_class&& o) noexcept(decltype(na_)::always_stealable)
 {
-  detail::destroy(root_, {});
-  detail::assign(root_, o.root_)(o.root_, nullptr);
+  if (na_.stealable(o.na_))
+  {
+    na_.clear(root_); na_.steal(o.na_);
+    detail::assign(root_, ms_, o.root_, o.ms_)(o.root_, o.ms_, nullptr, 0);
+    detail::assign(first_, last_, o.first_, o.last_)(
+      o.first_, o.last_, nullptr, nullptr);
+    sb_.t_ = std::exchange(o.sb_.t_, {});
+
+    if (!sb_.e_) compact(); // tombstones stay only in lazy containers
+
+    if constexpr(requires{ this->vc_; })
+    {
+      detail::assign(this->vc_, o.vc_)(o.vc_, 0);
+    }
+  }
+  else if constexpr(!decltype(na_)::always_stealable)
+  { // foreign allocator, move element by element
+    clear();
+    insert(
+      std::make_move_iterator(o.begin()),
+      std::make_move_iterator(o.end())
+    );
+    o.clear();
+  }
 
   return *this;
 }
@@ -110,16 +135,168 @@ static constexpr size_type max_size() noexcept
   return ~size_type{} / sizeof(node*);
 }
 
-void clear() noexcept(noexcept(detail::destroy(root_, {})))
+allocator_type get_allocator() const noexcept
 {
-  detail::destroy(root_, {}); root_ = {};
+  return na_.get_allocator();
+}
+
+void clear() noexcept
+{ // releases whole chunks of nodes
+  na_.clear(root_); root_ = first_ = last_ = {}; ms_ = sb_.t_ = {};
+
+  if constexpr(requires{ this->vc_; }) this->vc_ = {};
 }
 
-bool empty() const noexcept { return !root_; }
+bool empty() const noexcept { return !size(); }
+
+// rebuilds of up to n nodes use a reusable buffer, 0 frees it
+void scratch(size_type const n) { sb_.reset(n); }
+
+class bulkscope
+{ // emplace() stages nodes, that commit() sorts and merges into the tree
+  // at once, nodes not committed are destroyed, when the scope ends; the
+  // container must outlive the scope
+  this_class& c_;
+  decltype(node::r_) h_; // staged nodes, chained in emplacement order
+  decltype(&h_) t_{&h_};
+  node* x_{}; // last staged node
+  size_type n_{}; // staged node count
+
+  struct it
+  { // walks the sorted staged nodes, reading ahead, as merging relinks
+    // nodes, x_ is the node at hand and h_ links to the next one
+    bulkscope* s_;
+
+    auto operator*() const noexcept { return s_->x_; }
+
+    auto& operator++() noexcept
+    {
+      if (--s_->n_) s_->h_ = (s_->x_ = detail::node_of(s_->x_, s_->h_))->r_;
+
+      return *this;
+    }
+
+    bool operator==(it const& o) const noexcept
+    { // one of the iterators is the end
+      return !(s_ ? s_ : o.s_)->n_;
+    }
+  };
+
+  void release() noexcept
+  { // destroy the n_ staged nodes, starting with x_
+    for (auto n(x_); n_; --n_)
+    {
+      auto const m(n);
+
+      if (n_ > 1) n = detail::node_of(m, h_), h_ = n->r_;
+
+      c_.na_.attach(m); c_.na_.destroy(m);
+    }
+
+    t_ = &h_;
+  }
+
+public:
+  explicit bulkscope(this_class& c) noexcept: c_(c) { }
+
+  bulkscope(bulkscope const&) = delete;
+
+  ~bulkscope() noexcept
+  {
+    if (n_) x_ = detail::node_of(x_, h_), h_ = x_->r_, release();
+  }
+
+  //
+  void commit()
+  { // merge the staged nodes, should this throw, those not merged yet are
+    // destroyed
+    if (!n_) return;
+
+    c_.compact();
+
+    try
+    {
+      x_ = detail::node_of(x_, detail::sort_chain(h_, n_, x_));
+    }
+    catch (...)
+    { // h_ chains the staged nodes again
+      x_ = detail::node_of(x_, h_); h_ = x_->r_; release();
+
+      throw;
+    }
+
+    h_ = x_->r_;
+
+    try
+    {
+      detail::insert_sorted(
+        c_.root_,
+        c_.na_,
+        it{this},
+        it{},
+        [](auto const n) noexcept -> auto& { return n->key(); },
+        [&](auto const n) noexcept
+        {
+          if constexpr(requires{ c_.vc_; }) ++c_.vc_;
+
+          c_.na_.attach(n);
+
+          return n;
+        },
+        [&](auto const n, auto const s)
+        { // keys are unique, or the staged value joins the node's list
+          if constexpr(requires{ c_.vc_; })
+          {
+            n->v_.splice(n->v_.end(), s->v_); ++c_.vc_;
+          }
+
+          c_.na_.attach(s); c_.na_.destroy(s);
+        },
+        [](auto const n, decltype(n) l, decltype(n) r) noexcept
+        {
+          if constexpr(requires{ node::update_max(n, l, r); })
+          {
+            node::update_max(n, l, r);
+          }
+        }
+      );
+    }
+    catch (...)
+    {
+      release(); c_.ms_ = c_.na_.size(); c_.reset_ends();
+
+      throw;
+    }
+
+    t_ = &h_; c_.ms_ = c_.na_.size(); c_.reset_ends();
+  }
+
+  void emplace(auto&& ...a)
+  { // the node is detached from the pool's count, until the merge
+    auto const n(c_.na_.create(std::forward<decltype(a)>(a)...));
+    c_.na_.detach(n);
+
+    *t_ = detail::conv(x_ = n); *(t_ = &n->r_) = {}; ++n_;
+  }
+};
+
+auto bulk_load() noexcept { return bulkscope(*this); }
 
 void swap(this_class& o) noexcept
 {
-  detail::assign(root_, o.root_)(o.root_, root_);
+  na_.swap(o.na_);
+  detail::assign(root_, ms_, o.root_, o.ms_)(o.root_, o.ms_, root_, ms_);
+  detail::assign(first_, last_, o.first_, o.last_)(
+    o.first_, o.last_, first_, last_);
+  std::swap(sb_.t_, o.sb_.t_);
+
+  if (!sb_.e_) compact(); // tombstones stay only in lazy containers
+  if (!o.sb_.e_) o.compact();
+
+  if constexpr(requires{ this->vc_; })
+  {
+    detail::assign(this->vc_, o.vc_)(o.vc_, this->vc_);
+  }
 }
 
 //
@@ -127,7 +304,7 @@ template <int = 0>
 bool contains(auto const& k) const noexcept
   requires(detail::Comparable<Compare, key_type, decltype(k)>)
 {
-  return std::get<0>(detail::find(root_, {}, k));
+  return std::get<0>(found(detail::find(root_, {}, k)));
 }
 
 auto contains(key_type const k) const noexcept { return contains<0>(k); }
@@ -135,8 +312,106 @@ auto contains(key_type const k) const noexcept { return contains<0>(k); }
 //
 iterator erase(const_iterator a, const_iterator const b)
   noexcept(noexcept(erase(a)))
+{ // the nodes between a and b are detached together, O(log n + k)
+  auto const bn(const_cast<node*>(b.n()));
+
+  if (sb_.e_) [[unlikely]]
+  { // mark the nodes, then compact once, if due
+    for (; a != b; ++a) detail::mark(const_cast<node*>(a.n())), ++sb_.t_;
+
+    if (compactable())
+    {
+      compact(); return bn ? find(bn->key()) : end();
+    }
+    else
+    {
+      return {&last_, bn, const_cast<node*>(b.p())};
+    }
+  }
+
+  node* pa; // the last node, that stays before the range
+
+  if constexpr(requires{ this->vc_; })
+  {
+    if (a.n() == b.n())
+    { // the node of b stays
+      for (; a != b; a = erase(a));
+
+      if (auto const n(const_cast<node*>(a.n())); n)
+      { // erase(i, i) turns the const list iterator into a mutable one
+        return {&last_, n, const_cast<node*>(a.p()), n->v_.erase(a.i(),
+          a.i())};
+      }
+      else
+      {
+        return end();
+      }
+    }
+    else if (auto const n(a.n()); a.i() == n->v_.cbegin())
+    {
+      pa = std::get<0>(detail::prev_node(n, a.p()));
+    }
+    else
+    { // the head of the list of a stays
+      for (auto i(a.i()); i != n->v_.cend(); --this->vc_)
+      {
+        i = n->v_.erase(i);
+      }
+
+      pa = n;
+    }
+
+    if (bn)
+    {
+      for (auto& v(bn->v_); v.cbegin() != b.i(); --this->vc_)
+      {
+        v.erase(v.cbegin());
+      }
+    }
+  }
+  else
+  {
+    if (a == b) return {&last_, bn, const_cast<node*>(b.p())};
+
+    pa = std::get<0>(detail::prev_node(const_cast<node*>(a.n()),
+      const_cast<node*>(a.p())));
+  }
+
+  trim(
+    [&](auto const n) noexcept
+    {
+      return pa && (node::cmp(n->key(), pa->key()) <= 0);
+    },
+    [&](auto const n) noexcept
+    {
+      return bn && (node::cmp(n->key(), bn->key()) >= 0);
+    }
+  );
+
+  return bn ? iterator(&last_, detail::find(root_, {}, bn->key())) : end();
+}
+
+template <int = 0>
+size_type erase_range(auto const& lo, auto const& hi) noexcept
+  requires(
+    detail::Comparable<Compare, decltype(root_->key()), decltype(lo)> &&
+    detail::Comparable<Compare, decltype(root_->key()), decltype(hi)>
+  )
+{ // erase the elements with node keys in [lo, hi), interval starts, in
+  // case of an intervalmap
+  auto const s(size());
+
+  trim(
+    [&](auto const n) noexcept { return node::cmp(n->key(), lo) < 0; },
+    [&](auto const n) noexcept { return node::cmp(n->key(), hi) >= 0; }
+  );
+
+  return s - size();
+}
+
+auto erase_range(key_type const lo, key_type const hi) noexcept
 {
-  while (a != b) { a = erase(a); } return {&root_, a.n(), a.p()};
+  return erase_range<0>(lo, hi);
 }
 
 //
@@ -144,7 +419,7 @@ template <int = 0>
 iterator find(auto const& k) noexcept
   requires(detail::Comparable<Compare, key_type, decltype(k)>)
 {
-  return {&root_, detail::find(root_, {}, k)};
+  return {&last_, found(detail::find(root_, {}, k))};
 }
 
 auto find(key_type const k) noexcept { return find<0>(k); }
@@ -153,11 +428,41 @@ template <int = 0>
 const_iterator find(auto const& k) const noexcept
   requires(detail::Comparable<Compare, key_type, decltype(k)>)
 {
-  return {&root_, detail::find(root_, {}, k)};
+  return {&last_, found(detail::find(root_, {}, k))};
 }
 
 auto find(key_type const k) const noexcept { return find<0>(k); }
 
+//
+template <int = 0>
+iterator find_from(const_iterator const i, auto const& k) noexcept
+  requires(detail::Comparable<Compare, key_type, decltype(k)>)
+{ // finger search, starting at i
+  auto const [n, p](finger(i));
+
+  return {&last_, n ? found(detail::find_from(n, p, k)) : std::pair(n, p)};
+}
+
+auto find_from(const_iterator const i, key_type const k) noexcept
+{
+  return find_from<0>(i, k);
+}
+
+template <int = 0>
+const_iterator find_from(const_iterator const i, auto const& k)
+  const noexcept
+  requires(detail::Comparable<Compare, key_type, decltype(k)>)
+{
+  auto const [n, p](finger(i));
+
+  return {&last_, n ? found(detail::find_from(n, p, k)) : std::pair(n, p)};
+}
+
+auto find_from(const_iterator const i, key_type const k) const noexcept
+{
+  return find_from<0>(i, k);
+}
+
 //
 void insert(std::initializer_list<value_type> const l)
   noexcept(noexcept(insert(l.begin(), l.end())))
@@ -188,6 +493,42 @@ auto lower_bound(key_type const k) const noexcept
   return lower_bound<0>(k);
 }
 
+template <int = 0>
+iterator lower_bound_from(const_iterator const i, auto const& k) noexcept
+  requires(detail::Comparable<Compare, decltype(k), key_type>)
+{ // finger search, starting at i
+  auto const [n, p](finger(i));
+
+  return live(iterator(&last_,
+      n ? detail::lower_bound_from(n, p, k) : std::pair(n, p)
+    )
+  );
+}
+
+auto lower_bound_from(const_iterator const i, key_type const k) noexcept
+{
+  return lower_bound_from<0>(i, k);
+}
+
+template <int = 0>
+const_iterator lower_bound_from(const_iterator const i, auto const& k)
+  const noexcept
+  requires(detail::Comparable<Compare, decltype(k), key_type>)
+{
+  auto const [n, p](finger(i));
+
+  return live(const_iterator(&last_,
+      n ? detail::lower_bound_from(n, p, k) : std::pair(n, p)
+    )
+  );
+}
+
+auto lower_bound_from(const_iterator const i, key_type const k)
+  const noexcept
+{
+  return lower_bound_from<0>(i, k);
+}
+
 //
 template <int = 0>
 iterator upper_bound(auto const& k) noexcept
@@ -209,3 +550,190 @@ auto upper_bound(key_type const k) const noexcept
 {
   return upper_bound<0>(k);
 }
+
+//
+void pop_front() noexcept(noexcept(erase(cbegin()))) { erase(cbegin()); }
+
+void pop_back() noexcept(noexcept(erase(cbegin())))
+{
+  erase(std::prev(cend()));
+}
+
+private:
+static auto found(auto const np) noexcept
+{ // tombstones are not found
+  auto const n(std::get<0>(np));
+
+  return n && detail::is_marked(n) ? decltype(np){} : np;
+}
+
+static auto live(auto i) noexcept
+{ // step over a tombstone
+  if (auto const n(i.n()); n && detail::is_marked(n)) ++i;
+
+  return i;
+}
+
+size_type mark_key(auto const& k) noexcept
+{ // erase lazily, by key
+  if (auto const n(std::get<0>(found(detail::find(root_, {}, k)))); n)
+  {
+    detail::mark(n); ++sb_.t_;
+
+    if (compactable()) compact();
+
+    return 1;
+  }
+  else
+  {
+    return {};
+  }
+}
+
+iterator mark_node(const_iterator const i) noexcept
+{ // erase lazily, by iterator
+  auto const n(const_cast<node*>(i.n()));
+
+  iterator r(&last_, n, const_cast<node*>(i.p()));
+  ++r; detail::mark(n); ++sb_.t_;
+
+  if (compactable())
+  {
+    compact(); return r.n() ? find(r.n()->key()) : end();
+  }
+  else
+  {
+    return r;
+  }
+}
+
+void compact() noexcept
+{ // remove the tombstones with a full rebuild
+  if (node* qp{}; sb_.t_)
+  {
+    root_ = detail::rebalance(root_, {}, {}, qp, na_.size(), sb_);
+
+    reap(); ms_ = na_.size();
+  }
+}
+
+bool compactable() const noexcept
+{ // do the tombstones outweigh the slack of a balanced tree?
+  return Alpha::den * (na_.size() - sb_.t_) < Alpha::num * na_.size();
+}
+
+void reap() noexcept
+{ // destroy the tombstones, that rebuilds have removed from the tree
+  for (auto n(std::exchange(sb_.g_, {})); n;)
+  {
+    auto const m(detail::node_of(n, n->r_));
+
+    na_.destroy(n); n = m;
+  }
+
+  reset_ends();
+}
+
+auto finger(const_iterator const i) const noexcept
+{ // end() fingers start at the last node
+  return i.n() ?
+    std::pair(const_cast<node*>(i.n()), const_cast<node*>(i.p())) :
+    detail::last_pair(last_);
+}
+
+void trim(auto const& below, auto const& above) noexcept
+{ // erase the nodes, that are neither below nor above the range
+  auto const f(
+    [](auto const n, decltype(n) l, decltype(n) r) noexcept
+    {
+      if constexpr(requires{ node::update_max(n, l, r); })
+      {
+        node::update_max(n, l, r);
+      }
+    }
+  );
+
+  compact();
+
+  auto const s(na_.size());
+
+  if constexpr(requires{ this->vc_; })
+  { // the values of destroyed nodes are no longer counted
+    struct
+    {
+      detail::pool<node, Allocator>& a_;
+      size_type& c_;
+
+      void destroy(node* const n) const noexcept
+      {
+        c_ -= n->v_.size(); a_.destroy(n);
+      }
+    } na{na_, this->vc_};
+
+    detail::erase_range(root_, na, below, above, f);
+  }
+  else
+  {
+    detail::erase_range(root_, na_, below, above, f);
+  }
+
+  if (node* qp{}; detail::shrunk<Alpha>(s, na_.size(), ms_))
+  {
+    root_ = detail::rebalance(root_, {}, {}, qp, na_.size(), sb_, f);
+  }
+
+  reset_ends();
+}
+
+void reset_ends() noexcept
+{
+  first_ = root_ ? std::get<0>(detail::first_node(root_, {})) : nullptr;
+  last_ = root_ ? std::get<0>(detail::last_node(root_, {})) : nullptr;
+}
+
+void insert_end(node* const n) noexcept
+{ // n was inserted, it might be a new extreme node
+  if (sb_.g_) [[unlikely]]
+  { // the insertion's rebuild removed tombstones
+    reap();
+  }
+  else if (!first_)
+  {
+    first_ = last_ = n;
+  }
+  else if (node::cmp(n->key(), first_->key()) < 0)
+  {
+    first_ = n;
+  }
+  else if (node::cmp(last_->key(), n->key()) < 0)
+  {
+    last_ = n;
+  }
+}
+
+void erase_end_key(auto const& k) noexcept
+{ // the node with key k is about to be erased
+  if (first_ && (node::cmp(k, first_->key()) == 0))
+  {
+    erase_end(first_);
+  }
+  else if (last_ && (node::cmp(k, last_->key()) == 0))
+  {
+    erase_end(last_);
+  }
+}
+
+void erase_end(node* const n) noexcept
+{ // n is about to be erased, null links of extreme nodes encode parents
+  if (n == first_)
+  {
+    first_ = std::get<0>(detail::next_node(n, detail::left_node(n, {})));
+  }
+
+  if (n == last_)
+  {
+    last_ = std::get<0>(detail::prev_node(n, detail::right_node(n, {})));
+  }
+}
+
+public:
@@ -10,7 +10,10 @@ namespace xsg
 {
 
 template <typename Key, typename Value,
-  class Compare = std::compare_three_way>
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>,
+  class Policy = node_policy<>>
 class intervalmap
 {
 public:
@@ -22,6 +25,7 @@ public:
 
   using difference_type = detail::difference_type;
   using size_type = detail::size_type;
+  using allocator_type = Allocator;
   using reference = value_type&;
   using const_reference = value_type const&;
 
@@ -36,12 +40,22 @@ public:
 
     static constinit inline Compare const cmp;
 
-    std::uintptr_t l_, r_;
+    using allocator_type = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<value_type>;
+
+    detail::link_t<Policy> l_, r_;
 
     typename std::tuple_element_t<1, Key> m_;
-    xl::list<value_type> v_;
+    std::list<value_type, allocator_type> v_;
 
-    explicit node(auto&& k, auto&& ...a)
+    node(std::allocator_arg_t, allocator_type const& a, node const& o):
+      m_(o.m_),
+      v_(o.v_, a)
+    {
+    }
+
+    explicit node(std::allocator_arg_t, allocator_type const& al, auto&& k,
+      auto&& ...a)
       noexcept(noexcept(
           v_.emplace_back(
             std::piecewise_construct_t{},
@@ -49,7 +63,8 @@ public:
             std::forward_as_tuple(std::forward<decltype(a)>(a)...)
           )
         )
-      )
+      ):
+      v_(al)
     {
       v_.emplace_back(
         std::piecewise_construct_t{},
@@ -70,7 +85,8 @@ public:
     }
 
     //
-    static auto emplace(auto& r, auto&& k, auto&& ...a)
+    static auto emplace(auto& r, auto& na, auto const& sb,
+      auto&& k, auto&& ...a)
       requires(
         detail::Comparable<
           Compare,
@@ -83,12 +99,13 @@ public:
 
       auto const& [mink, maxk](k);
 
+      auto const h(detail::max_depth<Alpha>(na.size() + 1));
       node* q, *qp;
 
       auto const create_node([&](decltype(q) const p)
         {
           auto const q(
-            new node(
+            na.create(
               std::forward<decltype(k)>(k),
               std::forward<decltype(a)>(a)...
             )
@@ -101,7 +118,7 @@ public:
       );
 
       auto const f([&](auto&& f, auto const n, decltype(n) p,
-        enum Direction const d) -> size_type
+        enum Direction const d, size_type const hn) -> size_type
         {
           n->m_ = cmp(n->m_, maxk) < 0 ? maxk : n->m_;
 
@@ -112,9 +129,9 @@ public:
           {
             if (auto const l(detail::left_node(n, p)); l)
             {
-              if (auto const sz(f(f, l, n, LEFT)); sz)
+              if (auto const s(f(f, l, n, LEFT, hn + 1)); s)
               {
-                sl = sz;
+                sl = s;
               }
               else
               {
@@ -124,7 +141,9 @@ public:
             else
             {
               sl = bool(q = create_node(qp = n));
-              n->l_ = detail::conv(q, p);
+              n->l_ ^= detail::conv(q); q->l_ |= 1;
+
+              if (hn < h) return {}; // too deep?
             }
 
             sr = detail::size(detail::right_node(n, p), n);
@@ -133,9 +152,9 @@ public:
           {
             if (auto const r(detail::right_node(n, p)); r)
             {
-              if (auto const sz(f(f, r, n, RIGHT)); sz)
+              if (auto const s(f(f, r, n, RIGHT, hn + 1)); s)
               {
-                sr = sz;
+                sr = s;
               }
               else
               {
@@ -145,7 +164,9 @@ public:
             else
             {
               sr = bool(q = create_node(qp = n));
-              n->r_ = detail::conv(q, p);
+              n->r_ ^= detail::conv(q);
+
+              if (hn < h) return {};
             }
 
             sl = detail::size(detail::left_node(n, p), n);
@@ -162,14 +183,14 @@ public:
           }
 
           //
-          if (auto const s(1 + sl + sr), S(2 * s);
-            (3 * sl > S) || (3 * sr > S))
+          if (auto const s(1 + sl + sr);
+            detail::unbalanced<Alpha>(s, sl, sr))
           {
-            if (auto const nn(rebalance(n, p, q, qp, s)); p)
+            if (auto const nn(rebalance(n, p, q, qp, s, sb)); p)
             {
               d ?
-                p->r_ = detail::conv(nn, detail::right_node(p, n)) :
-                p->l_ = detail::conv(nn, detail::left_node(p, n));
+                p->r_ ^= detail::conv(n, nn) :
+                (p->l_ ^= detail::conv(n, nn), nn->l_ |= 1);
             }
             else
             {
@@ -187,7 +208,7 @@ public:
 
       if (r)
       {
-        f(f, r, {}, {});
+        f(f, r, {}, {}, {});
       }
       else
       {
@@ -238,17 +259,17 @@ public:
       );
     }
 
-    static iterator erase(auto& r0, const_iterator const i)
+    static iterator erase(auto& r0, auto& na, const_iterator const i)
       noexcept(
         noexcept(std::declval<node>().v_.erase(i.i())) &&
-        noexcept(node::erase(r0, i.n(), i.p()))
+        noexcept(node::erase(r0, na, i.n(), i.p()))
       )
     {
       if (auto const n(i.n()), p(i.p()); 1 == n->v_.size())
       {
-        auto const [nn, np, s](node::erase(r0, n, p));
+        auto const [nn, np, s](node::erase(r0, na, n, p));
 
-        return {&r0, nn, np};
+        return {i.ln(), nn, np};
       }
       else if (auto const it(i.i()); std::next(it) == n->v_.end())
       {
@@ -256,26 +277,27 @@ public:
 
         n->v_.erase(it);
 
-        return {&r0, ni.n(), ni.p()};
+        return {i.ln(), ni.n(), ni.p()};
       }
       else
       {
-        return {&r0, n, p, n->v_.erase(it)};
+        return {i.ln(), n, p, n->v_.erase(it)};
       }
     }
 
-    static inline auto erase(auto& r0, auto const pp, decltype(pp) p,
-      decltype(pp) n, std::uintptr_t* const q)
-      noexcept(noexcept(delete r0))
-    {
+    static inline auto erase(auto& r0, auto& na, auto const p,
+      decltype(p) n, decltype(p->l_)* const q) noexcept
+    { // q points to the link of p, that leads to n, or is null
       size_type const s(n->v_.size());
       auto [nnn, nnp](detail::next_node(n, p));
 
-      // pp - p - n - lr
+      auto const t(detail::is_left(n));
+
+      // p - n - lr
       if (auto const l(detail::left_node(n, p)),
         r(detail::right_node(n, p)); l && r)
       {
-        if (detail::size(l, n) < detail::size(r, n)) // erase from right side?
+        if (detail::right_deeper(l, r, n)) // erase from right side?
         {
           auto const [fnn, fnp](detail::first_node(r, n));
 
@@ -286,7 +308,7 @@ public:
 
           if (q)
           {
-            *q = detail::conv(fnn, pp);
+            *q ^= detail::conv(n, fnn);
           }
           else
           {
@@ -294,7 +316,7 @@ public:
           }
 
           // convert and attach l to fnn
-          fnn->l_ = detail::conv(l, p); 
+          fnn->l_ = detail::conv(l, p) | t;
 
           {
             auto const nfnn(detail::conv(n, fnn));
@@ -311,15 +333,14 @@ public:
           {
             // attach right node of fnn to parent left
             {
-              auto const fnpp(detail::left_node(fnp, fnn));
               auto const rn(detail::right_node(fnn, fnp));
 
-              fnp->l_ = detail::conv(rn, fnpp);
+              fnp->l_ ^= detail::conv(fnn, rn);
 
               if (rn)
               {
                 auto const fnnfnp(detail::conv(fnn, fnp));
-                rn->l_ ^= fnnfnp; rn->r_ ^= fnnfnp;
+                rn->l_ ^= fnnfnp | 1; rn->r_ ^= fnnfnp; // now a left child
               }
             }
 
@@ -345,7 +366,7 @@ public:
 
           if (q)
           {
-            *q = detail::conv(lnn, pp);
+            *q ^= detail::conv(n, lnn);
           }
           else
           {
@@ -353,7 +374,7 @@ public:
           }
 
           // convert and attach r to lnn
-          lnn->r_ = detail::conv(r, p); 
+          lnn->r_ = detail::conv(r, p);
 
           {
             auto const nlnn(detail::conv(n, lnn));
@@ -362,27 +383,26 @@ public:
 
           if (l == lnn)
           {
-            l->l_ ^= detail::conv(n, p);
+            l->l_ ^= detail::conv(n, p) | !t; // takes the place of n
 
             reset_max(r0, l->key());
           }
           else
           {
             {
-              auto const lnpp(detail::right_node(lnp, lnn));
               auto const ln(detail::left_node(lnn, lnp));
 
-              lnp->r_ = detail::conv(ln, lnpp);
+              lnp->r_ ^= detail::conv(lnn, ln);
 
               if (ln)
               {
                 auto const lnnlnp(detail::conv(lnn, lnp));
-                ln->l_ ^= lnnlnp; ln->r_ ^= lnnlnp;
+                ln->l_ ^= lnnlnp | 1; ln->r_ ^= lnnlnp; // now a right child
               }
             }
 
             // convert and attach l to lnn
-            lnn->l_ = detail::conv(l, p);
+            lnn->l_ = detail::conv(l, p) | t;
 
             {
               auto const nlnn(detail::conv(n, lnn));
@@ -405,12 +425,12 @@ public:
           }
 
           auto const np(detail::conv(n, p));
-          lr->l_ ^= np; lr->r_ ^= np;
+          lr->l_ ^= np | (detail::is_left(lr) != t); lr->r_ ^= np;
         }
 
         if (q)
         {
-          *q = detail::conv(lr, pp);
+          *q ^= detail::conv(n, lr);
 
           reset_max(r0, p->key());
         }
@@ -420,13 +440,13 @@ public:
         }
       }
 
-      delete n;
+      na.destroy(n);
 
       return std::tuple(nnn, nnp, s);
     }
 
-    static auto erase(auto& r0, auto&& k)
-      noexcept(noexcept(erase(r0, r0, r0, r0, {})))
+    static auto erase(auto& r0, auto& na, auto&& k)
+      noexcept(noexcept(erase(r0, na, r0, r0, {})))
       requires(
         detail::Comparable<
           Compare,
@@ -439,44 +459,33 @@ public:
       using node = std::remove_pointer_t<pointer>;
 
       auto const& [mink, maxk](k);
-      std::uintptr_t* q{};
+      decltype(r0->l_)* q{};
 
-      for (pointer pp{}, p{}, n(r0); n;)
+      for (pointer p{}, n(r0); n;)
       {
         if (auto const c(node::cmp(mink, n->key())); c < 0)
         {
-          detail::assign(pp, p, n, q)(p, n, detail::left_node(n, p), &n->l_);
+          detail::assign(p, n, q)(n, detail::left_node(n, p), &n->l_);
         }
         else if (c > 0)
         {
-          detail::assign(pp, p, n, q)(p, n, detail::right_node(n, p), &n->r_);
+          detail::assign(p, n, q)(n, detail::right_node(n, p), &n->r_);
         }
         else
         {
-          return erase(r0, pp, p, n, q);
+          return erase(r0, na, p, n, q);
         }
       }
 
       return std::tuple(pointer{}, pointer{}, size_type{});
     }
 
-    static auto erase(auto& r0, auto const n, decltype(n) const p)
-      noexcept(noexcept(erase(r0, r0, r0, r0, {})))
+    static auto erase(auto& r0, auto& na, auto const n,
+      decltype(n) const p)
+      noexcept(noexcept(erase(r0, na, r0, r0, {})))
     {
-      using pointer = std::remove_cvref_t<decltype(r0)>;
-      using node = std::remove_pointer_t<pointer>;
-
-      pointer pp{};
-      std::uintptr_t* q{};
-
-      if (p)
-      {
-        node::cmp(n->key(), p->key()) < 0 ?
-          detail::assign(pp, q)(detail::left_node(p, n), &p->l_) :
-          detail::assign(pp, q)(detail::right_node(p, n), &p->r_);
-      }
-
-      return erase(r0, pp, p, n, q);
+      return erase(r0, na, p, n,
+        p ? detail::is_left(n) ? &p->l_ : &p->r_ : nullptr);
     }
 
     static auto node_max(auto const n) noexcept
@@ -546,117 +555,43 @@ public:
       f(f, r0, {});
     }
 
-    static auto rebalance(auto const n, decltype(n) p,
-      decltype(n) q, auto& qp, size_type const sz) noexcept
+    static void update_max(auto const n, decltype(n) l, decltype(n) r)
+      noexcept
     {
-      auto const l(static_cast<node**>(XSG_ALLOCA(sizeof(node*) * sz)));
+      auto m(node_max(n));
 
-/*
-      {
-        auto k(l);
-        auto t(detail::first_node(n, p));
+      if (l && (cmp(m, l->m_) < 0)) m = l->m_;
+      if (r && (cmp(m, r->m_) < 0)) m = r->m_;
 
-        do
-        {
-          *k++ = std::get<0>(t);
-        }
-        while (std::get<0>(t =
-          detail::next_node(n, std::get<0>(t), std::get<1>(t))));
-      }
-*/
-
-      {
-        auto f([l(l)](auto&& f, auto const n,
-          decltype(n) const p) mutable noexcept -> void
-          {
-            if (n)
-            {
-              f(f, detail::left_node(n, p), n);
-
-              *l++ = n;
-
-              f(f, detail::right_node(n, p), n);
-            }
-          }
-        );
-
-        f(f, n, p);
-      }
+      n->m_ = m;
+    }
 
-      auto const f([l, q, &qp](auto&& f, auto const p,
-        std::size_t const a, decltype(a) b) noexcept -> node*
+    static auto rebalance(auto const n, decltype(n) p,
+      decltype(n) q, auto& qp, size_type const sz, auto const& sb) noexcept
+    {
+      return detail::rebalance(n, p, q, qp, sz, sb,
+        [](auto const n, decltype(n) l, decltype(n) r) noexcept
         {
-          auto const i(std::midpoint(a, b));
-          auto const n(l[i]);
-
-          if (n == q)
-          {
-            qp = p;
-          }
-
-          switch (b - a)
-          {
-            case 0:
-              n->l_ = n->r_ = detail::conv(p);
-
-              n->m_ = node_max(n);
-
-              break;
-
-            case 1:
-              {
-                // n - nb
-                auto const nb(l[b]);
-
-                if (nb == q)
-                {
-                  qp = n;
-                }
-
-                nb->l_ = nb->r_ = detail::conv(n);
-                n->l_ = detail::conv(p); n->r_ = detail::conv(nb, p);
-
-                n->m_ = std::max(
-                    node_max(n),
-                    nb->m_ = node_max(nb),
-                    [](auto&& a, auto&& b) noexcept
-                    {
-                      return node::cmp(a, b) < 0;
-                    }
-                  );
-              }
-
-              break;
-
-            default:
-              auto const l(f(f, n, a, i - 1)), r(f(f, n, i + 1, b));
-              detail::assign(n->l_, n->r_)(detail::conv(l, p), detail::conv(r, p));
-
-              n->m_ = std::max(
-                  {node_max(n), l->m_, r->m_},
-                  [](auto&& a, auto&& b) noexcept
-                  {
-                    return node::cmp(a, b) < 0;
-                  }
-                );
-          }
-
-          return n;
+          update_max(n, l, r);
         }
       );
-
-      //
-      return f(f, p, {}, sz - 1);
     }
   };
 
 private:
   using this_class = intervalmap;
   node* root_{};
+  node* first_{}, *last_{}; // the extreme nodes
+  detail::pool<node, Allocator> na_; // nodes
+  size_type ms_{}; // peak node count, since the last full rebuild
+  size_type vc_{}; // value count
+  detail::scratch<node> sb_;
 
 public:
   intervalmap() = default;
 
+  explicit intervalmap(allocator_type const& a) noexcept: na_(a) { }
+
   intervalmap(intervalmap const& o)
     noexcept(noexcept(*this = o))
     requires(std::is_copy_constructible_v<value_type>)
@@ -665,7 +600,8 @@ public:
   }
 
   intervalmap(intervalmap&& o)
-    noexcept(noexcept(*this = std::move(o)))
+    noexcept(noexcept(*this = std::move(o))):
+    na_(o.get_allocator())
   {
     *this = std::move(o);
   }
@@ -676,35 +612,33 @@ public:
     insert(i, j);
   }
 
+  intervalmap(sorted_t, std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(insert_sorted(i, j)))
+  {
+    try
+    {
+      insert_sorted(i, j);
+    }
+    catch (...)
+    { // the destructor will not run
+      na_.clear(root_);
+
+      throw;
+    }
+  }
+
   intervalmap(std::initializer_list<value_type> l)
     noexcept(noexcept(intervalmap(l.begin(), l.end()))):
     intervalmap(l.begin(), l.end())
   {
   }
 
-  ~intervalmap() noexcept(noexcept(delete root_))
-  {
-    detail::destroy(root_, {});
-  }
+  ~intervalmap() noexcept { na_.clear(root_); }
 
 # include "common.hpp"
 
   //
-  auto size() const noexcept
-  {
-    static constinit auto const f(
-      [](auto&& f, auto const n, decltype(n) p) noexcept -> size_type
-      {
-        return n ?
-          n->v_.size() +
-          f(f, detail::left_node(n, p), n) +
-          f(f, detail::right_node(n, p), n) :
-          size_type{};
-      }
-    );
-
-    return f(f, root_, {});
-  }
+  auto size() const noexcept { return vc_; }
 
   //
   template <int = 0>
@@ -744,6 +678,8 @@ public:
     noexcept(noexcept(
         node::emplace(
           root_,
+          na_,
+          sb_,
           std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...
         )
@@ -751,14 +687,19 @@ public:
     )
     requires(detail::Comparable<Compare, decltype(k), key_type>)
   {
-    return {
-      &root_,
+    auto const [n, p](
       node::emplace(
         root_,
+        na_,
+        sb_,
         std::forward<decltype(k)>(k),
         std::forward<decltype(a)>(a)...
       )
-    };
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
   }
 
   auto emplace(key_type k, auto&& ...a)
@@ -777,7 +718,7 @@ public:
   {
     auto const [nl, g](node::equal_range(root_, {}, k));
 
-    return std::pair(iterator(&root_, nl), iterator(&root_, g));
+    return std::pair(iterator(&last_, nl), iterator(&last_, g));
   }
 
   auto equal_range(key_type k) noexcept
@@ -791,7 +732,7 @@ public:
   {
     auto const [nl, g](node::equal_range(root_, {}, k));
 
-    return std::pair(const_iterator(&root_, nl), const_iterator(&root_, g));
+    return std::pair(const_iterator(&last_, nl), const_iterator(&last_, g));
   }
 
   auto equal_range(key_type k) const noexcept
@@ -802,11 +743,24 @@ public:
   //
   template <int = 0>
   size_type erase(auto&& k)
-    noexcept(noexcept(node::erase(root_, k)))
+    noexcept(noexcept(node::erase(root_, na_, k)))
     requires(detail::Comparable<Compare, decltype(k), key_type> &&
       !std::convertible_to<decltype(k), const_iterator>)
   {
-    return std::get<2>(node::erase(root_, k));
+    auto const sz(na_.size());
+
+    erase_end_key(std::get<0>(k));
+
+    auto const s(std::get<2>(node::erase(root_, na_, k)));
+
+    vc_ -= s;
+
+    if (node* qp{}; detail::shrunk<Alpha>(sz, na_.size(), ms_))
+    {
+      root_ = node::rebalance(root_, {}, {}, qp, na_.size(), sb_);
+    }
+
+    return s;
   }
 
   auto erase(key_type k) noexcept(noexcept(erase<0>(std::move(k))))
@@ -815,31 +769,82 @@ public:
   }
 
   iterator erase(const_iterator const i)
-    noexcept(noexcept(node::erase(root_, i)))
+    noexcept(noexcept(node::erase(root_, na_, i)))
   {
-    return node::erase(root_, i);
+    auto const s(na_.size());
+
+    if (1 == i.n()->v_.size()) erase_end(i.n());
+
+    auto r(node::erase(root_, na_, i));
+
+    --vc_;
+
+    if (detail::shrunk<Alpha>(s, na_.size(), ms_))
+    {
+      auto p(r.p());
+      root_ = node::rebalance(root_, {}, r.n(), p, na_.size(), sb_);
+      r = {&last_, r.n(), p, r.i()};
+    }
+
+    return r;
+  }
+
+  size_type erase_if(auto pred)
+    noexcept(noexcept(pred(std::declval<value_type&>())))
+  { // a single in-order pass, followed by a single rebuild
+    auto const s(vc_);
+
+    detail::erase_if(root_, na_,
+      [&](node* const n)
+      {
+        auto& v(n->v_);
+
+        for (auto i(v.begin()); i != v.end();
+          pred(*i) ? --vc_, i = v.erase(i) : ++i);
+
+        return !v.size();
+      },
+      [](auto const n, decltype(n) l, decltype(n) r) noexcept
+      {
+        node::update_max(n, l, r);
+      }
+    );
+
+    ms_ = na_.size(); reset_ends();
+
+    return s - vc_;
   }
 
   //
   iterator insert(value_type const& v)
-    noexcept(noexcept(node::emplace(root_, std::get<0>(v), std::get<1>(v))))
+    noexcept(noexcept(
+        node::emplace(root_, na_, sb_, std::get<0>(v), std::get<1>(v))
+      )
+    )
   {
-    return {
-        &root_,
-        node::emplace(root_, std::get<0>(v), std::get<1>(v))
-      };
+    auto const [n, p](
+      node::emplace(root_, na_, sb_, std::get<0>(v), std::get<1>(v))
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
   }
 
   iterator insert(value_type&& v)
     noexcept(noexcept(
-        node::emplace(root_, std::get<0>(v), std::move(std::get<1>(v)))
+        node::emplace(root_, na_, sb_, std::get<0>(v),
+          std::move(std::get<1>(v)))
       )
     )
   {
-    return {
-        &root_,
-        node::emplace(root_, std::get<0>(v), std::move(std::get<1>(v)))
-      };
+    auto const [n, p](
+      node::emplace(root_, na_, sb_, std::get<0>(v), std::move(std::get<1>(v)))
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
   }
 
   void insert(std::input_iterator auto const i, decltype(i) j)
@@ -865,6 +870,57 @@ public:
     );
   }
 
+  void insert_sorted(std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(emplace(std::get<0>(*i), std::get<1>(*i))))
+  { // [i, j) is sorted, merge in linear time
+    try
+    {
+      detail::insert_sorted(
+        root_,
+        na_,
+        i,
+        j,
+        [](auto const& v) noexcept -> auto&
+        {
+          return std::get<0>(std::get<0>(v));
+        },
+        [&](auto&& v)
+        { // count the value, once it is in
+          auto const n(
+            na_.create(
+              std::get<0>(std::forward<decltype(v)>(v)),
+              std::get<1>(std::forward<decltype(v)>(v))
+            )
+          );
+
+          ++vc_;
+
+          return n;
+        },
+        [&](auto const n, auto&& v)
+        {
+          n->v_.emplace_back(
+            std::get<0>(std::forward<decltype(v)>(v)),
+            std::get<1>(std::forward<decltype(v)>(v))
+          );
+          ++vc_;
+        },
+        [](auto const n, decltype(n) l, decltype(n) r) noexcept
+        {
+          node::update_max(n, l, r);
+        }
+      );
+    }
+    catch (...)
+    { // the tree was rebuilt from what was merged so far
+      ms_ = na_.size(); reset_ends();
+
+      throw;
+    }
+
+    ms_ = na_.size(); reset_ends();
+  }
+
   //
   template <int = 0>
   void all(auto const& k, auto g) const
@@ -973,17 +1029,17 @@ public:
 };
 
 //////////////////////////////////////////////////////////////////////////////
-template <int = 0, typename K, typename V, class C>
-inline auto erase(intervalmap<K, V, C>& c, auto&& k)
+template <int = 0, typename K, typename V, class C, class A, class R, class P>
+inline auto erase(intervalmap<K, V, C, A, R, P>& c, auto&& k)
   noexcept(noexcept(c.erase(std::forward<decltype(k)>(k))))
   requires(
     detail::Comparable<
       C,
       decltype(std::get<0>(k)),
-      decltype(intervalmap<K, V, C>::node::m_)
+      decltype(intervalmap<K, V, C, A, R, P>::node::m_)
     > &&
     !std::same_as<
-      decltype(intervalmap<K, V, C>::node::m_),
+      decltype(intervalmap<K, V, C, A, R, P>::node::m_),
       std::remove_cvref_t<decltype(k)>
     >
   )
@@ -991,27 +1047,49 @@ inline auto erase(intervalmap<K, V, C>& c, auto&& k)
   return c.erase(std::forward<decltype(k)>(k));
 }
 
-template <typename K, typename V, class C>
-inline auto erase(intervalmap<K, V, C>& c, K const& k)
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase(intervalmap<K, V, C, A, R, P>& c, K const& k)
   noexcept(noexcept(erase<0>(c, k)))
 {
   return erase<0>(c, k);
 }
 
-template <typename K, typename V, class C>
-inline auto erase_if(intervalmap<K, V, C>& c, auto pred)
-  noexcept(noexcept(pred(std::declval<K>()), c.erase(c.begin())))
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase_if(intervalmap<K, V, C, A, R, P>& c, auto pred)
+  noexcept(noexcept(c.erase_if(pred)))
+{
+  return c.erase_if(std::move(pred));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template <typename K, typename V, class C, class A, class R, class P>
+inline void swap(intervalmap<K, V, C, A, R, P>& l, decltype(l) r) noexcept
+{
+  l.swap(r);
+}
+
+namespace pmr
 {
-  typename std::remove_reference_t<decltype(c)>::size_type r{};
 
-  for (auto i(c.begin()); i.n(); pred(*i) ? ++r, i = c.erase(i) : ++i);
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Alpha = std::ratio<2, 3>>
+using intervalmap = xsg::intervalmap<Key, Value, Compare,
+  std::pmr::polymorphic_allocator<std::pair<Key const, Value>>, Alpha>;
 
-  return r;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-template <typename K, typename V, class C>
-inline void swap(intervalmap<K, V, C>& l, decltype(l) r) noexcept {l.swap(r);}
+namespace compact
+{ // 32-bit links
+
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>>
+using intervalmap = xsg::intervalmap<Key, Value, Compare, Allocator, Alpha,
+  node_policy<std::uint32_t>>;
+
+}
 
 }
 
@@ -49,7 +49,7 @@ void dump(auto n, decltype(n) p)
 //////////////////////////////////////////////////////////////////////////////
 int main()
 {
-  xsg::map<std::string, int> st{
+  xsg::ranked::map<std::string, int> st{
     {"a", -1},
     {"c", 1}
   };
@@ -100,7 +100,7 @@ int main()
 
   while (S)
   {
-    st.erase(std::next(st.begin(), rand() % S--));
+    st.erase(st.select(rand() % S--));
   }
 
   std::cout << std::chrono::nanoseconds(timer_t::now() - t0).count() << std::endl;
@@ -5,12 +5,16 @@
 #include "utils.hpp"
 
 #include "mapiterator.hpp"
+#include "nodehandle.hpp"
 
 namespace xsg
 {
 
 template <typename Key, typename Value,
-  class Compare = std::compare_three_way>
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>,
+  class Policy = node_policy<>>
 class map
 {
 public:
@@ -22,6 +26,7 @@ public:
 
   using difference_type = detail::difference_type;
   using size_type = detail::size_type;
+  using allocator_type = Allocator;
   using reference = value_type&;
   using const_reference = value_type const&;
 
@@ -36,7 +41,8 @@ public:
 
     static constinit inline Compare const cmp;
 
-    std::uintptr_t l_, r_;
+    detail::link_t<Policy> l_, r_;
+    [[no_unique_address]] detail::count_t<Policy> s_{1};
     value_type kv_;
 
     explicit node(auto&& k, auto&& ...a)
@@ -60,16 +66,33 @@ public:
     auto& key() const noexcept { return std::get<0>(kv_); }
 
     //
-    static auto emplace(auto& r, auto&& k, auto&& ...a)
-      noexcept(noexcept(new node(std::forward<decltype(k)>(k),
+    static auto revive(auto const t, auto const& sb, auto&& ...a)
+    { // an insertion, that found a tombstone, reuses it
+      if constexpr(std::is_move_assignable_v<Value>)
+      {
+        if (auto const [q, qp, s](t); !s && detail::is_marked(q))
+        {
+          std::get<1>(q->kv_) = Value(std::forward<decltype(a)>(a)...);
+          detail::unmark(q); --sb.t_;
+
+          return std::tuple(q, qp, true);
+        }
+      }
+
+      return t;
+    }
+
+    static auto emplace(auto& r, auto& na, auto const& sb,
+      auto&& k, auto&& ...a)
+      noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
         std::forward<decltype(a)>(a)...)))
       requires(detail::Comparable<Compare, decltype(k), key_type>)
     {
       auto const create_node([&](node* const p)
-        noexcept(noexcept(new node(std::forward<decltype(k)>(k),
+        noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...)))
         {
-          auto const q(new node(std::forward<decltype(k)>(k),
+          auto const q(na.create(std::forward<decltype(k)>(k),
             std::forward<decltype(a)>(a)...));
 
           q->l_ = q->r_ = detail::conv(p);
@@ -78,27 +101,164 @@ public:
         }
       );
 
-      return r ? detail::emplace(r, k, create_node) :
-        std::tuple<node*, node*, bool>(r = create_node({}), {}, true);
+      if (r)
+      {
+        return revive(
+            detail::emplace<Alpha>(r, na.size(), sb, k, create_node),
+            sb,
+            std::forward<decltype(a)>(a)...
+          );
+      }
+      else
+      {
+        r = create_node({});
+
+        return std::tuple<node*, node*, bool>(r, {}, true);
+      }
     }
+
+    static auto emplace_hint(auto& r, auto& na, auto const& sb,
+      node* const hn, node* const hp, node* const l, auto&& k, auto&& ...a)
+      noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
+        std::forward<decltype(a)>(a)...)))
+      requires(detail::Comparable<Compare, decltype(k), key_type>)
+    { // (hn, hp) is the hint, l is the last node
+      auto const create_node([&](node* const p)
+        noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
+          std::forward<decltype(a)>(a)...)))
+        {
+          auto const q(na.create(std::forward<decltype(k)>(k),
+            std::forward<decltype(a)>(a)...));
+
+          q->l_ = q->r_ = detail::conv(p);
+
+          return q;
+        }
+      );
+
+      if (r)
+      {
+        return revive(
+            detail::emplace<Alpha>(r, na.size(), sb, k, create_node,
+              hn, hp, l),
+            sb,
+            std::forward<decltype(a)>(a)...
+          );
+      }
+      else
+      {
+        r = create_node({});
+
+        return std::tuple<node*, node*, bool>(r, {}, true);
+      }
+    }
+  };
+
+  using node_type = nodehandle<node, detail::pool<node, Allocator>>;
+
+  struct insert_return_type
+  {
+    iterator position;
+    bool inserted;
+    node_type node;
   };
 
 private:
   using this_class = map;
   node* root_{};
+  node* first_{}, *last_{}; // the extreme nodes
+  detail::pool<node, Allocator> na_;
+  size_type ms_{}; // peak size, since the last full rebuild
+  detail::scratch<node> sb_;
+
+  template <bool A, bool AB, bool B>
+  void combine(auto&& o)
+  { // in-order merge with o, followed by a linear rebuild
+    compact();
+
+    if constexpr(!std::is_const_v<std::remove_reference_t<decltype(o)>>)
+    {
+      o.compact();
+    }
+    else if (o.sb_.t_) [[unlikely]]
+    { // o's tombstones can not be removed, merge a copy of o
+      return combine<A, AB, B>(this_class(o));
+    }
+
+    try
+    {
+      if (this == &o)
+      {
+        if constexpr(!AB) clear();
+      }
+      else if constexpr(std::is_const_v<std::remove_reference_t<decltype(o)>>
+        || std::is_lvalue_reference_v<decltype(o)> || !B)
+      { // o's nodes are only read, or copied
+        detail::combine<A, AB, B>(root_, na_, o.root_, o.size(),
+          static_cast<decltype(&na_)>(nullptr), sb_,
+          [&](node* const n)
+          {
+            return na_.create(std::get<0>(n->kv_), std::get<1>(n->kv_));
+          }
+        );
+
+        if constexpr(std::is_rvalue_reference_v<decltype(o)>) o.clear();
+      }
+      else if (na_.adoptable(o.na_))
+      { // o's nodes are moved
+        try
+        {
+          detail::combine<A, AB, B>(root_, na_, o.root_, o.size(), &o.na_,
+            sb_, [](node* const n) noexcept { return n; });
+        }
+        catch (...)
+        { // o got its moved nodes back
+          o.ms_ = o.size(); o.reset_ends();
+
+          throw;
+        }
+
+        o.root_ = o.first_ = o.last_ = {}; o.ms_ = {};
+      }
+      else
+      { // foreign allocator, o's elements are moved
+        detail::combine<A, AB, B>(root_, na_, o.root_, o.size(),
+          static_cast<decltype(&na_)>(nullptr), sb_,
+          [&](node* const n)
+          {
+            return na_.create(std::get<0>(n->kv_),
+              std::move(std::get<1>(n->kv_)));
+          }
+        );
+
+        o.clear();
+      }
+    }
+    catch (...)
+    { // the tree was rebuilt from what was merged so far
+      ms_ = size(); reset_ends();
+
+      throw;
+    }
+
+    ms_ = size(); reset_ends();
+  }
 
 public:
   map() = default;
 
+  explicit map(allocator_type const& a) noexcept: na_(a) { }
+
   map(map const& o)
-    noexcept(noexcept(map(o.begin(), o.end())))
-    requires(std::is_copy_constructible_v<value_type>):
-    map(o.begin(), o.end())
+    noexcept(noexcept(*this = o))
+    requires(std::is_copy_constructible_v<value_type>)
   {
+    *this = o;
   }
 
   map(map&& o)
-    noexcept(noexcept(*this = std::move(o)))
+    noexcept(noexcept(*this = std::move(o))):
+    na_(o.get_allocator())
   {
     *this = std::move(o);
   }
@@ -109,30 +269,50 @@ public:
     insert(i, j);
   }
 
+  map(sorted_t, std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(insert_sorted(i, j)))
+  {
+    try
+    {
+      insert_sorted(i, j);
+    }
+    catch (...)
+    { // the destructor will not run
+      na_.clear(root_);
+
+      throw;
+    }
+  }
+
   map(std::initializer_list<value_type> l)
     noexcept(noexcept(map(l.begin(), l.end()))):
     map(l.begin(), l.end())
   {
   }
 
-  ~map() noexcept(noexcept(detail::destroy(root_, {})))
-  {
-    detail::destroy(root_, {});
-  }
+  ~map() noexcept { na_.clear(root_); }
 
 # include "common.hpp"
 
   //
-  auto size() const noexcept { return detail::size(root_, {}); }
+  auto size() const noexcept { return na_.size() - sb_.t_; }
 
   //
   template <int = 0>
   auto& operator[](auto&& k)
-    noexcept(noexcept(node::emplace(root_, std::forward<decltype(k)>(k))))
+    noexcept(noexcept(
+        node::emplace(root_, na_, sb_, std::forward<decltype(k)>(k))
+      )
+    )
     requires(detail::Comparable<Compare, decltype(k), key_type>)
   {
-    return std::get<1>(std::get<0>(
-      node::emplace(root_, std::forward<decltype(k)>(k)))->kv_);
+    auto const [n, p, s](
+      node::emplace(root_, na_, sb_, std::forward<decltype(k)>(k))
+    );
+
+    if (s) insert_end(n);
+
+    return std::get<1>(n->kv_);
   }
 
   auto& operator[](key_type k)
@@ -178,17 +358,37 @@ public:
   size_type count(auto const& k) const noexcept
     requires(detail::Comparable<Compare, decltype(k), key_type>)
   {
-    return bool(detail::find(root_, {}, k));
+    return contains(k);
   }
 
   auto count(key_type const k) const noexcept { return count<0>(k); }
 
+  //
+  template <int = 0>
+  size_type count_range(auto const& l, auto const& h) const noexcept
+    requires(detail::Counted<node> &&
+      detail::Comparable<Compare, decltype(l), key_type> &&
+      detail::Comparable<Compare, decltype(h), key_type>)
+  { // the number of elements with keys in [l, h)
+    auto const a(detail::rank(root_, {}, l)), b(detail::rank(root_, {}, h));
+
+    return a < b ? b - a : size_type{};
+  }
+
+  auto count_range(key_type const l, key_type const h) const noexcept
+    requires(detail::Counted<node>)
+  {
+    return count_range<0>(l, h);
+  }
+
   //
   template <int = 0>
   auto emplace(auto&& k, auto&& ...a)
     noexcept(noexcept(
         node::emplace(
           root_,
+          na_,
+          sb_,
           std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...
         )
@@ -199,12 +399,16 @@ public:
     auto const [n, p, s](
       node::emplace(
         root_,
+        na_,
+        sb_,
         std::forward<decltype(k)>(k),
         std::forward<decltype(a)>(a)...
       )
     );
 
-    return std::pair(iterator(&root_, n, p), s);
+    if (s) insert_end(n);
+
+    return std::pair(iterator(&last_, n, p), s);
   }
 
   auto emplace(key_type k, auto&& ...a)
@@ -217,6 +421,51 @@ public:
     return emplace<0>(std::move(k), std::forward<decltype(a)>(a)...);
   }
 
+  //
+  template <int = 0>
+  iterator emplace_hint(const_iterator const i, auto&& k, auto&& ...a)
+    noexcept(noexcept(
+        node::emplace_hint(
+          root_,
+          na_,
+          sb_,
+          {},
+          {},
+          {},
+          std::forward<decltype(k)>(k),
+          std::forward<decltype(a)>(a)...
+        )
+      )
+    )
+    requires(detail::Comparable<Compare, decltype(k), key_type>)
+  { // insert as close as possible before i
+    auto const [n, p, s](
+      node::emplace_hint(
+        root_,
+        na_,
+        sb_,
+        const_cast<node*>(i.n_),
+        const_cast<node*>(i.p_),
+        last_,
+        std::forward<decltype(k)>(k),
+        std::forward<decltype(a)>(a)...
+      )
+    );
+
+    if (s) insert_end(n);
+
+    return {&last_, n, p};
+  }
+
+  auto emplace_hint(const_iterator const i, key_type k, auto&& ...a)
+    noexcept(noexcept(
+        emplace_hint<0>(i, std::move(k), std::forward<decltype(a)>(a)...)
+      )
+    )
+  {
+    return emplace_hint<0>(i, std::move(k), std::forward<decltype(a)>(a)...);
+  }
+
   //
   template <int = 0>
   auto equal_range(auto&& k) noexcept
@@ -226,7 +475,10 @@ public:
       detail::equal_range(root_, {}, std::forward<decltype(k)>(k))
     );
 
-    return std::pair(iterator(&root_, nl), iterator(&root_, g));
+    return std::pair(
+        live(iterator(&last_, nl)),
+        live(iterator(&last_, g))
+      );
   }
 
   auto equal_range(key_type k) noexcept
@@ -242,7 +494,10 @@ public:
       detail::equal_range(root_, {}, std::forward<decltype(k)>(k))
     );
 
-    return std::pair(const_iterator(&root_, nl), const_iterator(&root_, g));
+    return std::pair(
+        live(const_iterator(&last_, nl)),
+        live(const_iterator(&last_, g))
+      );
   }
 
   auto equal_range(key_type k) const noexcept
@@ -253,13 +508,23 @@ public:
   //
   template <int = 0>
   size_type erase(auto&& k)
-    noexcept(noexcept(detail::erase(root_, k)))
+    noexcept(noexcept(detail::erase(root_, na_, k)))
     requires(detail::Comparable<Compare, decltype(k), key_type> &&
       !std::convertible_to<decltype(k), const_iterator>)
   {
-    return bool(
-        std::get<0>(detail::erase(root_, std::forward<decltype(k)>(k)))
-      );
+    if (sb_.e_) [[unlikely]] return mark_key(k);
+
+    auto const s(na_.size());
+
+    erase_end_key(k);
+    detail::erase(root_, na_, std::forward<decltype(k)>(k));
+
+    if (node* qp{}; detail::shrunk<Alpha>(s, na_.size(), ms_))
+    {
+      root_ = detail::rebalance(root_, {}, {}, qp, na_.size(), sb_);
+    }
+
+    return s - na_.size();
   }
 
   auto erase(key_type k) noexcept(noexcept(erase<0>(std::move(k))))
@@ -271,28 +536,110 @@ public:
     noexcept(noexcept(
         detail::erase(
           root_,
+          na_,
           const_cast<node*>(i.n_),
           const_cast<node*>(i.p_)
         )
       )
     )
   {
-    return {
-        &root_,
+    if (sb_.e_) [[unlikely]] return mark_node(i);
+
+    auto const s(na_.size());
+
+    erase_end(const_cast<node*>(i.n_));
+
+    auto [n, p](
         detail::erase(
           root_,
+          na_,
           const_cast<node*>(i.n_),
           const_cast<node*>(i.p_)
         )
-      };
+      );
+
+    if (detail::shrunk<Alpha>(s, na_.size(), ms_))
+    {
+      root_ = detail::rebalance(root_, {}, n, p, na_.size(), sb_);
+    }
+
+    return {&last_, n, p};
+  }
+
+  void lazy_erase(bool const e) noexcept
+    requires(!detail::Counted<node> &&
+      std::is_move_assignable_v<Value>)
+  { // erasures only mark nodes as tombstones, while on, a full rebuild
+    // removes them, once they outweigh the tree's slack
+    if (!(sb_.e_ = e)) compact();
+  }
+
+  size_type erase_if(auto pred)
+    noexcept(noexcept(pred(std::declval<value_type&>())))
+  { // a single in-order pass, followed by a single rebuild
+    compact();
+
+    size_type r{};
+
+    detail::erase_if(root_, na_,
+      [&](node* const n)
+      {
+        return pred(n->kv_) ? ++r, true : false;
+      },
+      [](auto, auto, auto) noexcept {}
+    );
+
+    ms_ = size(); reset_ends();
+
+    return r;
   }
 
+  //
+  node_type extract(const_iterator const i) noexcept
+  { // unlink the node, the handle keeps it alive
+    if (sb_.t_) [[unlikely]]
+    { // the rebuild relinks i's node
+      compact(); return extract(find(i.n_->key()));
+    }
+
+    struct
+    {
+      detail::pool<node, Allocator>& a_;
+      void destroy(node* const n) const noexcept { a_.detach(n); }
+    } d{na_};
+
+    auto const s(na_.size());
+    auto const n(const_cast<node*>(i.n_));
+
+    erase_end(n);
+    detail::erase(root_, d, n, const_cast<node*>(i.p_));
+
+    if (node* qp{}; detail::shrunk<Alpha>(s, na_.size(), ms_))
+    {
+      root_ = detail::rebalance(root_, {}, {}, qp, na_.size(), sb_);
+    }
+
+    return {n, na_.lend()};
+  }
+
+  template <int = 0>
+  node_type extract(auto const& k) noexcept
+    requires(detail::Comparable<Compare, decltype(k), key_type> &&
+      !std::convertible_to<decltype(k), const_iterator>)
+  {
+    auto const i(find(k)); return i.n_ ? extract(i) : node_type();
+  }
+
+  auto extract(key_type const k) noexcept { return extract<0>(k); }
+
   //
   template <int = 0>
   auto insert(auto&& v)
     noexcept(noexcept(
         node::emplace(
           root_,
+          na_,
+          sb_,
           std::get<0>(std::forward<decltype(v)>(v)),
           std::get<1>(std::forward<decltype(v)>(v))
         )
@@ -309,12 +656,16 @@ public:
     auto const [n, p, s](
       node::emplace(
         root_,
+        na_,
+        sb_,
         std::get<0>(std::forward<decltype(v)>(v)),
         std::get<1>(std::forward<decltype(v)>(v))
       )
     );
 
-    return std::pair(iterator(&root_, n, p), s);
+    if (s) insert_end(n);
+
+    return std::pair(iterator(&last_, n, p), s);
   }
 
   auto insert(value_type const v)
@@ -323,6 +674,97 @@ public:
     return insert<0>(v);
   }
 
+  template <int = 0>
+  iterator insert(const_iterator const i, auto&& v)
+    noexcept(noexcept(
+        emplace_hint(
+          i,
+          std::get<0>(std::forward<decltype(v)>(v)),
+          std::get<1>(std::forward<decltype(v)>(v))
+        )
+      )
+    )
+    requires(
+      detail::Comparable<
+        Compare,
+        decltype(std::get<0>(std::forward<decltype(v)>(v))),
+        key_type
+      >
+    )
+  {
+    return emplace_hint(
+        i,
+        std::get<0>(std::forward<decltype(v)>(v)),
+        std::get<1>(std::forward<decltype(v)>(v))
+      );
+  }
+
+  auto insert(const_iterator const i, value_type const v)
+    noexcept(noexcept(insert<0>(i, v)))
+  {
+    return insert<0>(i, v);
+  }
+
+  insert_return_type insert(node_type&& nh)
+  {
+    compact();
+
+    if (!nh)
+    {
+      return {end(), false, {}};
+    }
+    else if (na_.owns(nh.n_) ||
+      (na_.sharable(*nh.a_) && (na_.share(), true)))
+    { // the node may live in a chunk of another pool, relink it
+      auto const n(nh.n_);
+
+      auto const create_node([&](node* const p) noexcept
+        {
+          n->l_ = n->r_ = detail::conv(p);
+          if constexpr(detail::Counted<node>) n->s_ = 1;
+
+          na_.attach(n);
+
+          return n;
+        }
+      );
+
+      auto const [q, p, s](
+        root_ ?
+          detail::emplace<Alpha>(root_, na_.size(), sb_, n->key(),
+            create_node) :
+          std::tuple<node*, node*, bool>(root_ = create_node({}), {}, true)
+      );
+
+      if (s)
+      {
+        insert_end(q); nh.release();
+
+        return {{&last_, q, p}, true, {}};
+      }
+      else
+      {
+        return {{&last_, q, p}, false, std::move(nh)};
+      }
+    }
+    else
+    { // the node belongs to another container, relocate the element
+      auto const [q, p, s](node::emplace(root_, na_, sb_,
+        std::move(nh.key()), std::move(nh.mapped())));
+
+      if (s)
+      {
+        insert_end(q); nh = {};
+
+        return {{&last_, q, p}, true, {}};
+      }
+      else
+      {
+        return {{&last_, q, p}, false, std::move(nh)};
+      }
+    }
+  }
+
   void insert(std::input_iterator auto const i, decltype(i) j)
     noexcept(noexcept(emplace(std::get<0>(*i), std::get<1>(*i))))
   {
@@ -346,12 +788,90 @@ public:
     );
   }
 
+  void insert_batch_sorted(std::forward_iterator auto const i,
+    decltype(i) j) noexcept(noexcept(insert_sorted(i, j)))
+  { // [i, j) is sorted, batches smaller than the container are merged in
+    // during a single descent, larger ones linearly
+    compact();
+
+    if (auto const m(std::distance(i, j)); size_type(m) >= na_.size())
+    {
+      insert_sorted(i, j);
+    }
+    else
+    {
+      try
+      {
+        detail::insert_batch_sorted<Alpha>(
+          root_,
+          na_.size() + m,
+          sb_,
+          i,
+          j,
+          [](auto const& v) noexcept -> auto& { return std::get<0>(v); },
+          [&](auto&& v)
+          {
+            return na_.create(
+                std::get<0>(std::forward<decltype(v)>(v)),
+                std::get<1>(std::forward<decltype(v)>(v))
+              );
+          },
+          [](auto, auto&&) noexcept {}
+        );
+      }
+      catch (...)
+      { // keep the cached ends valid
+        reset_ends();
+
+        throw;
+      }
+
+      reset_ends();
+    }
+  }
+
+  void insert_sorted(std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(emplace(std::get<0>(*i), std::get<1>(*i))))
+  { // [i, j) is sorted, merge in linear time
+    compact();
+
+    try
+    {
+      detail::insert_sorted(
+        root_,
+        na_,
+        i,
+        j,
+        [](auto const& v) noexcept -> auto& { return std::get<0>(v); },
+        [&](auto&& v)
+        {
+          return na_.create(
+              std::get<0>(std::forward<decltype(v)>(v)),
+              std::get<1>(std::forward<decltype(v)>(v))
+            );
+        },
+        [](auto, auto&&) noexcept {},
+        [](auto, auto, auto) noexcept {}
+      );
+    }
+    catch (...)
+    { // the tree was rebuilt from what was merged so far
+      ms_ = na_.size(); reset_ends();
+
+      throw;
+    }
+
+    ms_ = na_.size(); reset_ends();
+  }
+
   //
   template <int = 0>
   auto insert_or_assign(auto&& k, auto&& ...a)
     noexcept(noexcept(
         node::emplace(
           root_,
+          na_,
+          sb_,
           std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...
         )
@@ -362,11 +882,15 @@ public:
     auto const [n, p, s](
       node::emplace(
         root_,
+        na_,
+        sb_,
         std::forward<decltype(k)>(k),
         std::forward<decltype(a)>(a)...
       )
     );
 
+    if (s) insert_end(n);
+
     if (!s)
     {
       if constexpr(sizeof...(a))
@@ -379,7 +903,7 @@ public:
       }
     }
 
-    return std::pair(iterator(&root_, n, p), s);
+    return std::pair(iterator(&last_, n, p), s);
   }
 
   auto insert_or_assign(key_type k, auto&& ...a)
@@ -388,46 +912,354 @@ public:
   {
     return insert_or_assign<0>(std::move(k), std::forward<decltype(a)>(a)...);
   }
+
+  //
+  void join(this_class&& o)
+  { // all keys of o should either precede or follow ours, otherwise the
+    // containers are merged
+    compact(); o.compact();
+
+    if (!o.root_)
+    {
+    }
+    else if (!root_)
+    {
+      *this = std::move(o);
+    }
+    else if (auto const b(node::cmp(last_->key(), o.first_->key()) < 0);
+      na_.adoptable(o.na_) &&
+      (b || (node::cmp(o.last_->key(), first_->key()) < 0)))
+    { // disjoint key ranges, adopt o's nodes
+      if (b)
+      {
+        root_ = detail::join(na_, root_, o.root_, o.na_, sb_);
+        last_ = o.last_;
+      }
+      else
+      {
+        root_ = detail::join(na_, o.root_, root_, o.na_, sb_);
+        first_ = o.first_;
+      }
+
+      ms_ = size(); o.root_ = o.first_ = o.last_ = {}; o.ms_ = {};
+    }
+    else
+    {
+      insert_sorted(
+        std::make_move_iterator(o.begin()),
+        std::make_move_iterator(o.end())
+      );
+      o.clear();
+    }
+  }
+
+  void merge(this_class& o)
+  { // move o's elements, whose keys are not in this container, o keeps the
+    // rest, nodes are moved if the pools can share their nodes, or if no
+    // key is in both containers
+    compact(); o.compact();
+
+    auto const s(na_.sharable(o.na_));
+
+    if ((this == &o) || !o.root_)
+    {
+      return;
+    }
+    else if (s)
+    {
+      na_.share(o.na_);
+    }
+    else if (na_.adoptable(o.na_))
+    {
+      auto i(cbegin()), j(o.cbegin());
+
+      while (i.n_ && j.n_)
+      {
+        if (auto const c(node::cmp(i.n_->key(), j.n_->key())); c < 0)
+        {
+          ++i;
+        }
+        else if (c > 0)
+        {
+          ++j;
+        }
+        else
+        {
+          break;
+        }
+      }
+
+      if (!i.n_ || !j.n_) return set_union(std::move(o));
+    }
+
+    try
+    {
+      detail::merge(root_, na_, o.root_, o.na_, sb_,
+        [&](node* const n)
+        {
+          return s ? n : na_.create(std::get<0>(n->kv_),
+            std::move(std::get<1>(n->kv_)));
+        }
+      );
+    }
+    catch (...)
+    { // both trees were rebuilt
+      ms_ = size(); reset_ends();
+      o.ms_ = o.size(); o.reset_ends();
+
+      throw;
+    }
+
+    ms_ = size(); reset_ends();
+    o.ms_ = o.size(); o.reset_ends();
+  }
+
+  void merge(this_class&& o) { merge(o); }
+
+  //
+  size_type rank(const_iterator const i) const noexcept
+    requires(detail::Counted<node>)
+  { // the number of elements preceding i
+    return i.n_ ? detail::rank(i.n_, i.p_) : size();
+  }
+
+  template <int = 0>
+  size_type rank(auto const& k) const noexcept
+    requires(detail::Counted<node> &&
+      detail::Comparable<Compare, decltype(k), key_type> &&
+      !std::convertible_to<decltype(k), const_iterator>)
+  { // the number of elements with keys less than k
+    return detail::rank(root_, {}, k);
+  }
+
+  auto rank(key_type const k) const noexcept
+    requires(detail::Counted<node>)
+  {
+    return rank<0>(k);
+  }
+
+  //
+  iterator select(size_type const k) noexcept
+    requires(detail::Counted<node>)
+  { // the element of rank k, or end()
+    return {&last_, detail::select(root_, {}, k)};
+  }
+
+  const_iterator select(size_type const k) const noexcept
+    requires(detail::Counted<node>)
+  {
+    return {&last_, detail::select(root_, {}, k)};
+  }
+
+  //
+  void set_difference(auto&& o)
+    requires(std::same_as<std::remove_cvref_t<decltype(o)>, this_class>)
+  { // erase the elements, whose keys are in o
+    combine<true, false, false>(std::forward<decltype(o)>(o));
+  }
+
+  void set_intersection(auto&& o)
+    requires(std::same_as<std::remove_cvref_t<decltype(o)>, this_class>)
+  { // keep the elements, whose keys are in o
+    combine<false, true, false>(std::forward<decltype(o)>(o));
+  }
+
+  void set_symmetric_difference(auto&& o)
+    requires(std::same_as<std::remove_cvref_t<decltype(o)>, this_class>)
+  { // keep the elements, whose keys are in either container, but not both
+    combine<true, false, true>(std::forward<decltype(o)>(o));
+  }
+
+  void set_union(auto&& o)
+    requires(std::same_as<std::remove_cvref_t<decltype(o)>, this_class>)
+  { // add o's elements, whose keys are not in this container
+    combine<true, true, true>(std::forward<decltype(o)>(o));
+  }
+
+  //
+  template <int = 0>
+  this_class split(auto const& k)
+    requires(detail::Comparable<Compare, decltype(k), key_type>)
+  { // the elements with keys not less than k are moved into the returned
+    // container, the smaller part is relinked, or relocated, should the
+    // pools be unable to share nodes, the rest is rebuilt
+    compact();
+
+    this_class r(get_allocator());
+
+    if (!root_ || (node::cmp(last_->key(), k) < 0))
+    {
+    }
+    else if (node::cmp(k, first_->key()) <= 0)
+    {
+      swap(r);
+    }
+    else
+    {
+      auto const s(na_.sharable(r.na_));
+
+      if (s) na_.share(r.na_);
+
+      if (detail::split(root_, na_, r.root_, r.na_, k,
+        [&](node* const n)
+        {
+          return s ? n : r.na_.create(std::get<0>(n->kv_),
+            std::move_if_noexcept(std::get<1>(n->kv_)));
+        }
+      ))
+      {
+        swap(r);
+      }
+
+      ms_ = size(); reset_ends();
+      r.ms_ = r.size(); r.reset_ends();
+    }
+
+    return r;
+  }
+
+  auto split(key_type const k) { return split<0>(k); }
 };
 
 //////////////////////////////////////////////////////////////////////////////
-template <int = 0, typename K, typename V, class C>
-inline auto erase(map<K, V, C>& c, auto const& k)
+template <int = 0, typename K, typename V, class C, class A, class R, class P>
+inline auto erase(map<K, V, C, A, R, P>& c, auto const& k)
   noexcept(noexcept(c.erase(K(k))))
   requires(!detail::Comparable<C, decltype(k), K>)
 {
   return c.erase(K(k));
 }
 
-template <int = 0, typename K, typename V, class C>
-inline auto erase(map<K, V, C>& c, auto const& k)
+template <int = 0, typename K, typename V, class C, class A, class R, class P>
+inline auto erase(map<K, V, C, A, R, P>& c, auto const& k)
   noexcept(noexcept(c.erase(k)))
   requires(detail::Comparable<C, decltype(k), K>)
 {
   return c.erase(k);
 }
 
-template <typename K, typename V, class C>
-inline auto erase(map<K, V, C>& c, K const k)
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase(map<K, V, C, A, R, P>& c, K const k)
   noexcept(noexcept(erase<0>(c, k)))
 {
   return erase<0>(c, k);
 }
 
-template <typename K, typename V, class C>
-inline auto erase_if(map<K, V, C>& c, auto pred)
-  noexcept(noexcept(pred(std::declval<K const&>()), c.erase(c.begin())))
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase_if(map<K, V, C, A, R, P>& c, auto pred)
+  noexcept(noexcept(c.erase_if(pred)))
 {
-  typename std::remove_reference_t<decltype(c)>::size_type r{};
+  return c.erase_if(std::move(pred));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto join(map<K, V, C, A, R, P>&& l, decltype(l) r)
+{
+  l.join(std::move(r));
+
+  return std::move(l);
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_difference(map<K, V, C, A, R, P> l, decltype(l) const& r)
+{
+  l.set_difference(r); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_difference(map<K, V, C, A, R, P> l, decltype(l)&& r)
+{
+  l.set_difference(std::move(r)); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_intersection(map<K, V, C, A, R, P> l, decltype(l) const& r)
+{
+  l.set_intersection(r); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_intersection(map<K, V, C, A, R, P> l, decltype(l)&& r)
+{
+  l.set_intersection(std::move(r)); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_symmetric_difference(map<K, V, C, A, R, P> l,
+  decltype(l) const& r)
+{
+  l.set_symmetric_difference(r); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_symmetric_difference(map<K, V, C, A, R, P> l,
+  decltype(l)&& r)
+{
+  l.set_symmetric_difference(std::move(r)); return l;
+}
 
-  for (auto i(c.begin()); i; pred(*i) ? ++r, i = c.erase(i) : ++i);
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_union(map<K, V, C, A, R, P> l, decltype(l) const& r)
+{
+  l.set_union(r); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto set_union(map<K, V, C, A, R, P> l, decltype(l)&& r)
+{
+  l.set_union(std::move(r)); return l;
+}
+
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto split(map<K, V, C, A, R, P>&& c, auto const& k)
+{ // (keys less than k, the rest)
+  auto r(c.split(k));
 
-  return r;
+  return std::pair(std::move(c), std::move(r));
 }
 
 //////////////////////////////////////////////////////////////////////////////
-template <typename K, typename V, class C>
-inline void swap(map<K, V, C>& l, decltype(l) r) noexcept { l.swap(r); }
+template <typename K, typename V, class C, class A, class R, class P>
+inline void swap(map<K, V, C, A, R, P>& l, decltype(l) r) noexcept
+{
+  l.swap(r);
+}
+
+namespace pmr
+{
+
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Alpha = std::ratio<2, 3>>
+using map = xsg::map<Key, Value, Compare,
+  std::pmr::polymorphic_allocator<std::pair<Key const, Value>>, Alpha>;
+
+}
+
+namespace compact
+{ // 32-bit links
+
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>>
+using map = xsg::map<Key, Value, Compare, Allocator, Alpha,
+  node_policy<std::uint32_t>>;
+
+}
+
+namespace ranked
+{ // order statistics
+
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>>
+using map = xsg::map<Key, Value, Compare, Allocator, Alpha,
+  node_policy<std::uintptr_t, true>>;
+
+}
 
 }
 
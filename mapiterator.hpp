@@ -16,7 +16,7 @@ class mapiterator
   friend mapiterator<T const>;
 
   T* n_, *p_;
-  T* const* r_;
+  T* const* ln_; // the last node, cached by the container
 
 public:
   using iterator_category = std::bidirectional_iterator_tag;
@@ -30,29 +30,30 @@ public:
   using pointer = value_type*;
   using reference = value_type&;
 
-  template <typename, typename, class> friend class map;
-  template <typename, class> friend class set;
+  template <typename, typename, class, class, class, class>
+  friend class map;
+  template <typename, class, class, class, class> friend class set;
 
 public:
   mapiterator() = default;
 
-  mapiterator(T* const* const r) noexcept:
+  mapiterator(T* const* const l) noexcept:
     n_(),
-    r_(r)
+    ln_(l)
   {
   }
 
-  mapiterator(T* const* const r, auto&& t) noexcept:
+  mapiterator(T* const* const l, auto&& t) noexcept:
     n_(std::get<0>(t)),
     p_(std::get<1>(t)),
-    r_(r)
+    ln_(l)
   {
   }
 
-  mapiterator(T* const* const r, T* const n, T* const p) noexcept:
+  mapiterator(T* const* const l, T* const n, T* const p) noexcept:
     n_(n),
     p_(p),
-    r_(r)
+    ln_(l)
   {
   }
 
@@ -62,7 +63,7 @@ public:
   mapiterator(iterator_t const& o) noexcept requires(std::is_const_v<T>):
     n_(o.n_),
     p_(o.p_),
-    r_(o.r_)
+    ln_(o.ln_)
   {
   }
 
@@ -73,50 +74,52 @@ public:
   mapiterator& operator=(iterator_t const& o) noexcept
     requires(std::is_const_v<T>)
   {
-    n_ = o.n_; p_ = o.p_; r_ = o.r_; return *this;
+    n_ = o.n_; p_ = o.p_; ln_ = o.ln_; return *this;
   }
 
   bool operator==(mapiterator const& o) const noexcept { return n_ == o.n_; }
 
-  // increment, decrement
+  // increment, decrement, tombstones are stepped over
   auto& operator++() noexcept
   {
-    std::tie(n_, p_) = detail::next_node(n_, p_); return *this;
+    do std::tie(n_, p_) = detail::next_node(n_, p_);
+    while (n_ && detail::is_marked(n_));
+
+    return *this;
   }
 
   auto& operator--() noexcept
   {
     std::tie(n_, p_) = n_ ?
       detail::prev_node(n_, p_) :
-      detail::last_node(*r_, {});
+      detail::last_pair(*ln_);
+
+    while (n_ && detail::is_marked(n_))
+    {
+      std::tie(n_, p_) = detail::prev_node(n_, p_);
+    }
 
     return *this;
   }
 
   mapiterator operator++(int) noexcept
   {
-    auto const n(n_), p(p_);
-
-    std::tie(n_, p_) = detail::next_node(n_, p_);
-
-    return {r_, n, p};
+    auto const r(*this); ++*this; return r;
   }
 
   mapiterator operator--(int) noexcept
   {
-    auto const n(n_), p(p_);
-
-    std::tie(n_, p_) = n_ ?
-      detail::prev_node(n_, p_) :
-      detail::last_node(*r_, {});
-
-    return {r_, n, p};
+    auto const r(*this); --*this; return r;
   }
 
   // member access
   auto operator->() const noexcept { return &n_->kv_; }
   auto& operator*() const noexcept { return n_->kv_; }
 
+  //
+  auto n() const noexcept { return n_; }
+  auto p() const noexcept { return p_; }
+
   //
   explicit operator bool() const noexcept { return n_; }
 };
@@ -1,5 +1,7 @@
 #include <iostream>
 
+#include "xl/list.hpp"
+
 #include "multimap.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
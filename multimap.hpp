@@ -10,7 +10,10 @@ namespace xsg
 {
 
 template <typename Key, typename Value,
-  class Compare = std::compare_three_way>
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>,
+  class Policy = node_policy<>>
 class multimap
 {
 public:
@@ -22,6 +25,7 @@ public:
 
   using difference_type = detail::difference_type;
   using size_type = detail::size_type;
+  using allocator_type = Allocator;
   using reference = value_type&;
   using const_reference = value_type const&;
 
@@ -36,10 +40,19 @@ public:
 
     static constinit inline Compare const cmp;
 
-    std::uintptr_t l_, r_;
-    xl::list<value_type> v_;
+    using allocator_type = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<value_type>;
 
-    explicit node(auto&& k, auto&& ...a)
+    detail::link_t<Policy> l_, r_;
+    std::list<value_type, allocator_type> v_;
+
+    node(std::allocator_arg_t, allocator_type const& a, node const& o):
+      v_(o.v_, a)
+    {
+    }
+
+    explicit node(std::allocator_arg_t, allocator_type const& al, auto&& k,
+      auto&& ...a)
       noexcept(noexcept(
           v_.emplace_back(
             std::piecewise_construct_t{},
@@ -47,7 +60,8 @@ public:
             std::forward_as_tuple(std::forward<decltype(a)>(a)...)
           )
         )
-      )
+      ):
+      v_(al)
     {
       v_.emplace_back(
         std::piecewise_construct_t{},
@@ -60,16 +74,17 @@ public:
     auto& key() const noexcept { return std::get<0>(v_.front()); }
 
     //
-    static auto emplace(auto& r, auto&& k, auto&& ...a)
-      noexcept(noexcept(new node(std::forward<decltype(k)>(k),
+    static auto emplace(auto& r, auto& na, auto const& sb,
+      auto&& k, auto&& ...a)
+      noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
         std::forward<decltype(a)>(a)...)))
       requires(detail::Comparable<Compare, decltype(k), key_type>)
     {
       auto const create_node([&](node* const p)
-        noexcept(noexcept(new node(std::forward<decltype(k)>(k),
+        noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...)))
         {
-          auto const q(new node(std::forward<decltype(k)>(k),
+          auto const q(na.create(std::forward<decltype(k)>(k),
             std::forward<decltype(a)>(a)...));
 
           q->l_ = q->r_ = detail::conv(p);
@@ -80,7 +95,9 @@ public:
 
       if (r)
       {
-        auto const [q, qp, s](detail::emplace(r, k, create_node));
+        auto const [q, qp, s](
+          detail::emplace<Alpha>(r, na.size(), sb, k, create_node)
+        );
 
         if (!s) q->v_.emplace_back(std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...);
@@ -89,21 +106,61 @@ public:
       }
       else
       {
-        return std::pair<node*, node*>(r = create_node({}), {});
+        r = create_node({});
+
+        return std::pair<node*, node*>(r, {});
       }
     }
 
-    static iterator erase(auto& r0, const_iterator const i)
+    static auto emplace_hint(auto& r, auto& na, auto const& sb,
+      node* const hn, node* const hp, node* const l, auto&& k, auto&& ...a)
+      noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
+        std::forward<decltype(a)>(a)...)))
+      requires(detail::Comparable<Compare, decltype(k), key_type>)
+    { // (hn, hp) is the hint, l is the last node
+      auto const create_node([&](node* const p)
+        noexcept(noexcept(na.create(std::forward<decltype(k)>(k),
+          std::forward<decltype(a)>(a)...)))
+        {
+          auto const q(na.create(std::forward<decltype(k)>(k),
+            std::forward<decltype(a)>(a)...));
+
+          q->l_ = q->r_ = detail::conv(p);
+
+          return q;
+        }
+      );
+
+      if (r)
+      {
+        auto const [q, qp, s](
+          detail::emplace<Alpha>(r, na.size(), sb, k, create_node, hn, hp, l)
+        );
+
+        if (!s) q->v_.emplace_back(std::forward<decltype(k)>(k),
+          std::forward<decltype(a)>(a)...);
+
+        return std::pair(q, qp);
+      }
+      else
+      {
+        r = create_node({});
+
+        return std::pair<node*, node*>(r, {});
+      }
+    }
+
+    static iterator erase(auto& r0, auto& na, const_iterator const i)
       noexcept(
         noexcept(std::declval<node>().v_.erase(i.i())) &&
-        noexcept(node::erase(r0, i.n(), i.p()))
+        noexcept(node::erase(r0, na, i.n(), i.p()))
       )
     {
       if (auto const n(i.n()), p(i.p()); 1 == n->v_.size())
       {
-        auto const [nn, np, s](node::erase(r0, n, p));
+        auto const [nn, np, s](node::erase(r0, na, n, p));
 
-        return {&r0, nn, np};
+        return {i.ln(), nn, np};
       }
       else if (auto const it(i.i()); std::next(it) == n->v_.end())
       {
@@ -111,219 +168,73 @@ public:
 
         n->v_.erase(it);
 
-        return {&r0, ni.n(), ni.p()};
+        return {i.ln(), ni.n(), ni.p()};
       }
       else
       {
-        return {&r0, n, p, n->v_.erase(it)};
+        return {i.ln(), n, p, n->v_.erase(it)};
       }
     }
 
-    static inline auto erase(auto& r0, auto const pp, decltype(pp) p,
-      decltype(pp) n, std::uintptr_t* const q)
-      noexcept(noexcept(delete r0))
+    static auto erase(auto& r0, auto& na, auto const p, decltype(p) n,
+      decltype(p->l_)* const q) noexcept
     {
-      auto const s(n->v_.size()); // !!!
-      auto [nnn, nnp](detail::next_node(n, p));
-
-      // pp - p - n - lr
-      if (auto const l(detail::left_node(n, p)),
-        r(detail::right_node(n, p)); l && r)
-      {
-        if (detail::size(l, n) < detail::size(r, n)) // erase from right side?
-        {
-          auto const [fnn, fnp](detail::first_node(r, n));
-
-          if (fnn == nnn)
-          {
-            nnp = p;
-          }
-
-          if (q)
-          {
-            *q = detail::conv(fnn, pp);
-          }
-          else
-          {
-            r0 = fnn;
-          }
-
-          // convert and attach l to fnn
-          fnn->l_ = detail::conv(l, p); 
-
-          {
-            auto const nfnn(detail::conv(n, fnn));
-            l->l_ ^= nfnn; l->r_ ^= nfnn;
-          }
-
-          if (r == fnn)
-          {
-            r->r_ ^= detail::conv(n, p);
-          }
-          else
-          {
-            // attach right node of fnn to parent left
-            {
-              auto const fnpp(detail::left_node(fnp, fnn));
-              auto const rn(detail::right_node(fnn, fnp));
-
-              fnp->l_ = detail::conv(rn, fnpp);
-
-              if (rn)
-              {
-                auto const fnnfnp(detail::conv(fnn, fnp));
-                rn->l_ ^= fnnfnp; rn->r_ ^= fnnfnp;
-              }
-            }
-
-            // convert and attach r to fnn
-            fnn->r_ = detail::conv(r, p);
-
-            {
-              auto const nfnn(detail::conv(n, fnn));
-              r->l_ ^= nfnn; r->r_ ^= nfnn;
-            }
-          }
-        }
-        else // erase from the left side
-        {
-          auto const [lnn, lnp](detail::last_node(l, n));
-
-          if (r == nnn)
-          {
-            nnp = lnn;
-          }
-
-          if (q)
-          {
-            *q = detail::conv(lnn, pp);
-          }
-          else
-          {
-            r0 = lnn;
-          }
-
-          // convert and attach r to lnn
-          lnn->r_ = detail::conv(r, p); 
-
-          {
-            auto const nlnn(detail::conv(n, lnn));
-            r->l_ ^= nlnn; r->r_ ^= nlnn;
-          }
-
-          if (l == lnn)
-          {
-            l->l_ ^= detail::conv(n, p);
-          }
-          else
-          {
-            {
-              auto const lnpp(detail::right_node(lnp, lnn));
-              auto const ln(detail::left_node(lnn, lnp));
-
-              lnp->r_ = detail::conv(ln, lnpp);
-
-              if (ln)
-              {
-                auto const lnnlnp(detail::conv(lnn, lnp));
-                ln->l_ ^= lnnlnp; ln->r_ ^= lnnlnp;
-              }
-            }
-
-            // convert and attach l to lnn
-            lnn->l_ = detail::conv(l, p);
-
-            {
-              auto const nlnn(detail::conv(n, lnn));
-              l->l_ ^= nlnn; l->r_ ^= nlnn;
-            }
-          }
-        }
-      }
-      else
-      {
-        auto const lr(l ? l : r);
-
-        if (lr)
-        {
-          if (lr == nnn)
-          {
-            nnp = p;
-          }
-
-          auto const np(detail::conv(n, p));
-          lr->l_ ^= np; lr->r_ ^= np;
-        }
-
-        if (q)
-        {
-          *q = detail::conv(lr, pp);
-        }
-        else
-        {
-          r0 = lr;
-        }
-      }
-
-      delete n;
+      auto const s(n->v_.size());
+      auto const [nnn, nnp](detail::erase(r0, na, p, n, q));
 
       return std::tuple(nnn, nnp, s);
     }
 
-    static auto erase(auto& r0, auto&& k)
-      noexcept(noexcept(erase(r0, r0, r0, r0, {})))
+    static auto erase(auto& r0, auto& na, auto&& k)
+      noexcept(noexcept(erase(r0, na, r0, r0, {})))
     {
       using pointer = std::remove_cvref_t<decltype(r0)>;
       using node = std::remove_pointer_t<pointer>;
 
-      std::uintptr_t* q{};
+      decltype(r0->l_)* q{};
 
-      for (pointer pp{}, p{}, n(r0); n;)
+      for (pointer p{}, n(r0); n;)
       {
         if (auto const c(node::cmp(k, n->key())); c < 0)
         {
-          detail::assign(pp, p, n, q)(p, n, detail::left_node(n, p), &n->l_);
+          detail::assign(p, n, q)(n, detail::left_node(n, p), &n->l_);
         }
         else if (c > 0)
         {
-          detail::assign(pp, p, n, q)(p, n, detail::right_node(n, p), &n->r_);
+          detail::assign(p, n, q)(n, detail::right_node(n, p), &n->r_);
         }
         else
         {
-          return erase(r0, pp, p, n, q);
+          return erase(r0, na, p, n, q);
         }
       }
 
       return std::tuple(pointer{}, pointer{}, decltype(r0->v_.size()){});
     }
 
-    static auto erase(auto& r0, auto const n, decltype(n) const p)
-      noexcept(noexcept(erase(r0, r0, r0, r0, {})))
+    static auto erase(auto& r0, auto& na, auto const n,
+      decltype(n) const p)
+      noexcept(noexcept(erase(r0, na, r0, r0, {})))
     {
-      using pointer = std::remove_cvref_t<decltype(r0)>;
-      using node = std::remove_pointer_t<pointer>;
-
-      pointer pp{};
-      std::uintptr_t* q{};
-
-      if (p)
-      {
-        node::cmp(n->key(), p->key()) < 0 ?
-          detail::assign(pp, q)(detail::left_node(p, n), &p->l_) :
-          detail::assign(pp, q)(detail::right_node(p, n), &p->r_);
-      }
-
-      return erase(r0, pp, p, n, q);
+      return erase(r0, na, p, n,
+        p ? detail::is_left(n) ? &p->l_ : &p->r_ : nullptr);
     }
   };
 
 private:
   using this_class = multimap;
   node* root_{};
+  node* first_{}, *last_{}; // the extreme nodes
+  detail::pool<node, Allocator> na_; // nodes
+  size_type ms_{}; // peak node count, since the last full rebuild
+  size_type vc_{}; // value count
+  detail::scratch<node> sb_;
 
 public:
   multimap() = default;
 
+  explicit multimap(allocator_type const& a) noexcept: na_(a) { }
+
   multimap(multimap const& o)
     noexcept(noexcept(*this = o))
     requires(std::is_copy_constructible_v<value_type>)
@@ -332,7 +243,8 @@ public:
   }
 
   multimap(multimap&& o)
-    noexcept(noexcept(*this = std::move(o)))
+    noexcept(noexcept(*this = std::move(o))):
+    na_(o.get_allocator())
   {
     *this = std::move(o);
   }
@@ -344,33 +256,34 @@ public:
     insert(i, j);
   }
 
+  multimap(sorted_t, std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(insert_sorted(i, j)))
+    requires(std::is_constructible_v<value_type, decltype(*i)>)
+  {
+    try
+    {
+      insert_sorted(i, j);
+    }
+    catch (...)
+    { // the destructor will not run
+      na_.clear(root_);
+
+      throw;
+    }
+  }
+
   multimap(std::initializer_list<value_type> l)
     noexcept(noexcept(multimap(l.begin(), l.end()))):
     multimap(l.begin(), l.end())
   {
   }
 
-  ~multimap() noexcept(noexcept(delete root_)) { detail::destroy(root_, {}); }
+  ~multimap() noexcept { na_.clear(root_); }
 
 # include "common.hpp"
 
   //
-  auto size() const noexcept
-  {
-    static constinit auto const f(
-      [](auto&& f, auto const n, decltype(n) p) noexcept ->
-        decltype(n->v_.size())
-      {
-        return n ?
-          n->v_.size() +
-          f(f, detail::left_node(n, p), n) +
-          f(f, detail::right_node(n, p), n) :
-          decltype(n->v_.size()){};
-      }
-    );
-
-    return f(f, root_, {});
-  }
+  auto size() const noexcept { return vc_; }
 
   //
   template <int = 0>
@@ -404,29 +317,80 @@ public:
     noexcept(noexcept(
         node::emplace(
           root_,
+          na_,
+          sb_,
           std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...
         )
       )
     )
   {
-    return {
-        &root_,
-        node::emplace(
+    auto const [n, p](
+      node::emplace(
+        root_,
+        na_,
+        sb_,
+        std::forward<decltype(k)>(k),
+        std::forward<decltype(a)>(a)...
+      )
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
+  }
+
+  auto emplace(key_type k, auto&& ...a)
+    noexcept(noexcept(
+        emplace<0>(std::move(k), std::forward<decltype(a)>(a)...)
+      )
+    )
+  {
+    return emplace<0>(std::move(k), std::forward<decltype(a)>(a)...);
+  }
+
+  //
+  template <int = 0>
+  iterator emplace_hint(const_iterator const i, auto&& k, auto&& ...a)
+    noexcept(noexcept(
+        node::emplace_hint(
           root_,
+          na_,
+          sb_,
+          {},
+          {},
+          {},
           std::forward<decltype(k)>(k),
           std::forward<decltype(a)>(a)...
         )
-      };
+      )
+    )
+  { // insert as close as possible before i
+    auto const [n, p](
+      node::emplace_hint(
+        root_,
+        na_,
+        sb_,
+        const_cast<node*>(i.n()),
+        const_cast<node*>(i.p()),
+        last_,
+        std::forward<decltype(k)>(k),
+        std::forward<decltype(a)>(a)...
+      )
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
   }
 
-  auto emplace(key_type k, auto&& ...a)
+  auto emplace_hint(const_iterator const i, key_type k, auto&& ...a)
     noexcept(noexcept(
-        emplace<0>(std::move(k), std::forward<decltype(a)>(a)...)
+        emplace_hint<0>(i, std::move(k), std::forward<decltype(a)>(a)...)
       )
     )
   {
-    return emplace<0>(std::move(k), std::forward<decltype(a)>(a)...);
+    return emplace_hint<0>(i, std::move(k), std::forward<decltype(a)>(a)...);
   }
 
   //
@@ -436,7 +400,7 @@ public:
   {
     auto const [nl, g](detail::equal_range(root_, {}, k));
 
-    return std::pair(iterator(&root_, nl), iterator(&root_, g));
+    return std::pair(iterator(&last_, nl), iterator(&last_, g));
   }
 
   auto equal_range(key_type k) noexcept
@@ -450,7 +414,7 @@ public:
   {
     auto const [nl, g](detail::equal_range(root_, {}, k));
 
-    return std::pair(const_iterator(&root_, nl), const_iterator(&root_, g));
+    return std::pair(const_iterator(&last_, nl), const_iterator(&last_, g));
   }
 
   auto equal_range(key_type k) const noexcept
@@ -461,11 +425,24 @@ public:
   //
   template <int = 0>
   auto erase(auto&& k)
-    noexcept(noexcept(node::erase(root_, k)))
+    noexcept(noexcept(node::erase(root_, na_, k)))
     requires(detail::Comparable<Compare, decltype(k), key_type> &&
       !std::convertible_to<decltype(k), const_iterator>)
   {
-    return std::get<2>(node::erase(root_, k));
+    auto const sz(na_.size());
+
+    erase_end_key(k);
+
+    auto const s(std::get<2>(node::erase(root_, na_, k)));
+
+    vc_ -= s;
+
+    if (node* qp{}; detail::shrunk<Alpha>(sz, na_.size(), ms_))
+    {
+      root_ = detail::rebalance(root_, {}, {}, qp, na_.size(), sb_);
+    }
+
+    return s;
   }
 
   auto erase(key_type k) noexcept(noexcept(erase<0>(std::move(k))))
@@ -475,28 +452,94 @@ public:
   }
 
   iterator erase(const_iterator const i)
-    noexcept(noexcept(node::erase(root_, i)))
+    noexcept(noexcept(node::erase(root_, na_, i)))
   {
-    return node::erase(root_, i);
+    auto const s(na_.size());
+
+    if (1 == i.n()->v_.size()) erase_end(i.n());
+
+    auto r(node::erase(root_, na_, i));
+
+    --vc_;
+
+    if (detail::shrunk<Alpha>(s, na_.size(), ms_))
+    {
+      auto p(r.p());
+      root_ = detail::rebalance(root_, {}, r.n(), p, na_.size(), sb_);
+      r = {&last_, r.n(), p, r.i()};
+    }
+
+    return r;
+  }
+
+  size_type erase_if(auto pred)
+    noexcept(noexcept(pred(std::declval<value_type&>())))
+  { // a single in-order pass, followed by a single rebuild
+    auto const s(vc_);
+
+    detail::erase_if(root_, na_,
+      [&](node* const n)
+      {
+        auto& v(n->v_);
+
+        for (auto i(v.begin()); i != v.end();
+          pred(*i) ? --vc_, i = v.erase(i) : ++i);
+
+        return !v.size();
+      },
+      [](auto, auto, auto) noexcept {}
+    );
+
+    ms_ = na_.size(); reset_ends();
+
+    return s - vc_;
   }
 
   //
   iterator insert(value_type const& v)
-    noexcept(noexcept(node::emplace(root_, std::get<0>(v), std::get<1>(v))))
+    noexcept(noexcept(
+        node::emplace(root_, na_, sb_, std::get<0>(v), std::get<1>(v))
+      )
+    )
   {
-    return {&root_, node::emplace(root_, std::get<0>(v), std::get<1>(v))};
+    auto const [n, p](
+      node::emplace(root_, na_, sb_, std::get<0>(v), std::get<1>(v))
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
   }
 
   iterator insert(value_type&& v)
     noexcept(noexcept(
-        node::emplace(root_, std::get<0>(v), std::move(std::get<1>(v)))
+        node::emplace(root_, na_, sb_, std::get<0>(v),
+          std::move(std::get<1>(v)))
       )
     )
   {
-    return {
-        &root_,
-        node::emplace(root_, std::get<0>(v), std::move(std::get<1>(v)))
-      };
+    auto const [n, p](
+      node::emplace(root_, na_, sb_, std::get<0>(v), std::move(std::get<1>(v)))
+    );
+
+    insert_end(n); ++vc_;
+
+    return {&last_, n, p};
+  }
+
+  iterator insert(const_iterator const i, value_type const& v)
+    noexcept(noexcept(emplace_hint(i, std::get<0>(v), std::get<1>(v))))
+  {
+    return emplace_hint(i, std::get<0>(v), std::get<1>(v));
+  }
+
+  iterator insert(const_iterator const i, value_type&& v)
+    noexcept(noexcept(
+        emplace_hint(i, std::get<0>(v), std::move(std::get<1>(v)))
+      )
+    )
+  {
+    return emplace_hint(i, std::get<0>(v), std::move(std::get<1>(v)));
   }
 
   void insert(std::input_iterator auto const i, decltype(i) j)
@@ -521,46 +564,166 @@ public:
       }
     );
   }
+
+  void insert_batch_sorted(std::forward_iterator auto const i,
+    decltype(i) j) noexcept(noexcept(insert_sorted(i, j)))
+  { // [i, j) is sorted, batches smaller than the container are merged in
+    // during a single descent, larger ones linearly
+    if (auto const m(std::distance(i, j)); size_type(m) >= na_.size())
+    {
+      insert_sorted(i, j);
+    }
+    else
+    {
+      try
+      {
+        detail::insert_batch_sorted<Alpha>(
+          root_,
+          na_.size() + m,
+          sb_,
+          i,
+          j,
+          [](auto const& v) noexcept -> auto& { return std::get<0>(v); },
+          [&](auto&& v)
+          { // count the value, once it is in
+            auto const n(
+              na_.create(
+                std::get<0>(std::forward<decltype(v)>(v)),
+                std::get<1>(std::forward<decltype(v)>(v))
+              )
+            );
+
+            ++vc_;
+
+            return n;
+          },
+          [&](auto const n, auto&& v)
+          {
+            n->v_.emplace_back(
+              std::get<0>(std::forward<decltype(v)>(v)),
+              std::get<1>(std::forward<decltype(v)>(v))
+            );
+            ++vc_;
+          }
+        );
+      }
+      catch (...)
+      { // keep the cached ends valid
+        reset_ends();
+
+        throw;
+      }
+
+      reset_ends();
+    }
+  }
+
+  void insert_sorted(std::input_iterator auto const i, decltype(i) j)
+    noexcept(noexcept(emplace(std::get<0>(*i), std::get<1>(*i))))
+  { // [i, j) is sorted, merge in linear time
+    try
+    {
+      detail::insert_sorted(
+        root_,
+        na_,
+        i,
+        j,
+        [](auto const& v) noexcept -> auto& { return std::get<0>(v); },
+        [&](auto&& v)
+        { // count the value, once it is in
+          auto const n(
+            na_.create(
+              std::get<0>(std::forward<decltype(v)>(v)),
+              std::get<1>(std::forward<decltype(v)>(v))
+            )
+          );
+
+          ++vc_;
+
+          return n;
+        },
+        [&](auto const n, auto&& v)
+        {
+          n->v_.emplace_back(
+            std::get<0>(std::forward<decltype(v)>(v)),
+            std::get<1>(std::forward<decltype(v)>(v))
+          );
+          ++vc_;
+        },
+        [](auto, auto, auto) noexcept {}
+      );
+    }
+    catch (...)
+    { // the tree was rebuilt from what was merged so far
+      ms_ = na_.size(); reset_ends();
+
+      throw;
+    }
+
+    ms_ = na_.size(); reset_ends();
+  }
 };
 
 //////////////////////////////////////////////////////////////////////////////
-template <int = 0, typename K, typename V, class C>
-inline auto erase(multimap<K, V, C>& c, auto const& k)
+template <int = 0, typename K, typename V, class C, class A, class R, class P>
+inline auto erase(multimap<K, V, C, A, R, P>& c, auto const& k)
   noexcept(noexcept(c.erase(K(k))))
   requires(!detail::Comparable<C, decltype(k), K>)
 {
   return c.erase(K(k));
 }
 
-template <int = 0, typename K, typename V, class C>
-inline auto erase(multimap<K, V, C>& c, auto const& k)
+template <int = 0, typename K, typename V, class C, class A, class R, class P>
+inline auto erase(multimap<K, V, C, A, R, P>& c, auto const& k)
   noexcept(noexcept(c.erase(k)))
   requires(detail::Comparable<C, decltype(k), K>)
 {
   return c.erase(k);
 }
 
-template <typename K, typename V, class C>
-inline auto erase(multimap<K, V, C>& c, K const k)
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase(multimap<K, V, C, A, R, P>& c, K const k)
   noexcept(noexcept(erase<0>(c, k)))
 {
   return erase<0>(c, k);
 }
 
-template <typename K, typename V, class C>
-inline auto erase_if(multimap<K, V, C>& c, auto pred)
-  noexcept(noexcept(pred(std::declval<K>()), c.erase(c.begin())))
+template <typename K, typename V, class C, class A, class R, class P>
+inline auto erase_if(multimap<K, V, C, A, R, P>& c, auto pred)
+  noexcept(noexcept(c.erase_if(pred)))
+{
+  return c.erase_if(std::move(pred));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template <typename K, typename V, class C, class A, class R, class P>
+inline void swap(multimap<K, V, C, A, R, P>& l, decltype(l) r) noexcept
+{
+  l.swap(r);
+}
+
+namespace pmr
 {
-  typename std::remove_reference_t<decltype(c)>::size_type r{};
 
-  for (auto i(c.begin()); i; pred(*i) ? ++r, i = c.erase(i) : ++i);
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Alpha = std::ratio<2, 3>>
+using multimap = xsg::multimap<Key, Value, Compare,
+  std::pmr::polymorphic_allocator<std::pair<Key const, Value>>, Alpha>;
 
-  return r;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-template <typename K, typename V, class C>
-inline void swap(multimap<K, V, C>& l, decltype(l) r) noexcept { l.swap(r); }
+namespace compact
+{ // 32-bit links
+
+template <typename Key, typename Value,
+  class Compare = std::compare_three_way,
+  class Allocator = std::allocator<std::pair<Key const, Value>>,
+  class Alpha = std::ratio<2, 3>>
+using multimap = xsg::multimap<Key, Value, Compare, Allocator, Alpha,
+  node_policy<std::uint32_t>>;
+
+}
 
 }
 
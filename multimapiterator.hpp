@@ -2,10 +2,9 @@
 # define XSG_MULTIMAPITERATOR_HPP
 # pragma once
 
+#include <list>
 #include <type_traits>
 
-#include "xl/list.hpp"
-
 namespace xsg
 {
 
@@ -38,25 +37,25 @@ private:
   node_t* n_, *p_;
   std::conditional_t<
     std::is_const_v<T>,
-    typename xl::list<std::remove_const_t<value_type>>::const_iterator,
-    typename xl::list<std::remove_const_t<value_type>>::iterator
+    typename decltype(node_t::v_)::const_iterator,
+    typename decltype(node_t::v_)::iterator
   > i_;
-  node_t* const* r_;
+  node_t* const* ln_; // the last node, cached by the container
 
 public:
   multimapiterator() = default;
 
-  multimapiterator(decltype(r_) const r) noexcept:
+  multimapiterator(decltype(ln_) const l) noexcept:
     n_(),
     i_(),
-    r_(r)
+    ln_(l)
   {
   }
 
-  multimapiterator(decltype(r_) const r, auto&& t) noexcept:
+  multimapiterator(decltype(ln_) const l, auto&& t) noexcept:
     n_(std::get<0>(t)),
     p_(std::get<1>(t)),
-    r_(r)
+    ln_(l)
   {
     if (n_)
     {
@@ -71,11 +70,11 @@ public:
     }
   }
 
-  multimapiterator(decltype(r_) const r, decltype(n_) const n,
+  multimapiterator(decltype(ln_) const l, decltype(n_) const n,
     decltype(n) const p) noexcept:
     n_(n),
     p_(p),
-    r_(r)
+    ln_(l)
   {
     if (n)
     {
@@ -90,12 +89,12 @@ public:
     }
   }
 
-  multimapiterator(decltype(r_) const r, decltype(n_) const n,
+  multimapiterator(decltype(ln_) const l, decltype(n_) const n,
     decltype(n) p, decltype(i_) const i) noexcept:
     n_(n),
     p_(p),
     i_(i),
-    r_(r)
+    ln_(l)
   {
   }
 
@@ -107,7 +106,7 @@ public:
     n_(o.n_),
     p_(o.p_),
     i_(o.i_),
-    r_(o.r_)
+    ln_(o.ln_)
   {
   }
 
@@ -129,6 +128,10 @@ public:
       {
         i_ = n_->v_.begin();
       }
+      else
+      { // as end() is
+        i_ = {};
+      }
     }
 
     return *this;
@@ -138,7 +141,7 @@ public:
   {
     if (!n_)
     {
-      if (std::tie(n_, p_) = detail::last_node(*r_, {}); n_)
+      if (std::tie(n_, p_) = detail::last_pair(*ln_); n_)
       {
         i_ = std::prev(n_->v_.end());
       }
@@ -169,6 +172,7 @@ public:
   auto& i() const noexcept { return i_; }
   auto n() const noexcept { return n_; }
   auto p() const noexcept { return p_; }
+  auto ln() const noexcept { return ln_; }
 
   //
   explicit operator bool() const noexcept { return n_; }
@@ -1,5 +1,7 @@
 #include <iostream>
 
+#include "xl/list.hpp"
+
 #include "multiset.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,132 @@
+#ifndef XSG_NODEHANDLE_HPP
+# define XSG_NODEHANDLE_HPP
+# pragma once
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace xsg
+{
+
+template <typename T, class P>
+class nodehandle
+{ // owns an extracted node, the node's chunk outlives the container and
+  // its clear(), until the node is destroyed
+  T* n_{};
+  std::optional<typename P::allocator_type> a_;
+  mutable std::remove_cvref_t<decltype(std::declval<T>().key())>* k_{};
+
+  template <typename, typename, class, class, class, class>
+  friend class map;
+  template <typename, class, class, class, class> friend class set;
+
+  nodehandle(T* const n, typename P::allocator_type const& a) noexcept:
+    n_(n),
+    a_(a)
+  {
+  }
+
+  void release() noexcept
+  { // the node was attached to a pool
+    n_ = {}; k_ = {}; a_.reset();
+  }
+
+  static auto& unconst(auto const& k)
+    noexcept(std::is_nothrow_copy_constructible_v<
+      std::remove_cvref_t<decltype(k)>>)
+  { // replace the const key object with a mutable copy; as the key is not
+    // a complete object, the copy transparently replaces it, a throwing
+    // move terminates
+    using K = std::remove_cvref_t<decltype(k)>;
+
+    auto const p(const_cast<K*>(std::addressof(k)));
+    K c(k);
+
+    [&]() noexcept
+    {
+      std::destroy_at(p); std::construct_at(p, std::move(c));
+    }();
+
+    return *p;
+  }
+
+  static void move(auto& a, auto& b) noexcept
+  { // allocators need not be assignable
+    a.reset(); if (b) a.emplace(*b), b.reset();
+  }
+
+  void reset() noexcept
+  {
+    if (n_) std::destroy_at(n_), P::drop(*a_, n_), release();
+  }
+
+public:
+  using value_type = typename T::value_type;
+  using key_type = std::remove_cvref_t<decltype(std::declval<T>().key())>;
+
+  nodehandle() = default;
+
+  nodehandle(nodehandle&& o) noexcept:
+    n_(std::exchange(o.n_, nullptr)),
+    a_(std::exchange(o.a_, std::nullopt)),
+    k_(std::exchange(o.k_, nullptr))
+  {
+  }
+
+  ~nodehandle() noexcept { reset(); }
+
+  //
+  nodehandle& operator=(nodehandle&& o) noexcept
+  {
+    if (this != &o)
+    {
+      reset();
+
+      n_ = std::exchange(o.n_, nullptr); k_ = std::exchange(o.k_, nullptr);
+      move(a_, o.a_);
+    }
+
+    return *this;
+  }
+
+  explicit operator bool() const noexcept { return n_; }
+
+  //
+  bool empty() const noexcept { return !n_; }
+
+  auto get_allocator() const noexcept { return *a_; }
+
+  key_type& key() const noexcept(noexcept(unconst(n_->key())))
+  { // the key may be changed, before the node is reinserted, it is made
+    // mutable, when first asked for
+    return k_ ? *k_ : *(k_ = &unconst(n_->key()));
+  }
+
+  auto& mapped() const noexcept
+    requires(!std::is_same_v<value_type, key_type>)
+  {
+    return std::get<1>(n_->kv_);
+  }
+
+  key_type& value() const noexcept(noexcept(key()))
+    requires(std::is_same_v<value_type, key_type>)
+  {
+    return key();
+  }
+
+  void swap(nodehandle& o) noexcept
+  {
+    std::swap(n_, o.n_); std::swap(k_, o.k_);
+
+    decltype(a_) a;
+    move(a, a_); move(a_, o.a_); move(o.a_, a);
+  }
+
+  friend void swap(nodehandle& l, nodehandle& r) noexcept { l.swap(r); }
+};
+
+}
+
+#endif // XSG_NODEHANDLE_HPP
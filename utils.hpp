@@ -2,24 +2,38 @@
 #define XSG_UTILS_HPP
 # pragma once
 
-#if defined(_WIN32)
-# include <malloc.h>
-# define XSG_ALLOCA(x) _alloca(x)
-#else
-# include <stdlib.h>
-# define XSG_ALLOCA(x) alloca(x)
-#endif // XSG_ALLOCA
-
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 #include <algorithm>
+#include <bit>
 #include <compare>
+#include <memory>
+#include <memory_resource>
+#include <new>
 
 #include <numeric> // std::midpoint()
+#include <ratio>
+#include <span>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
+namespace xsg
+{
+
+template <typename Link = std::uintptr_t, bool Counted = false>
+struct node_policy
+{ // std::uint32_t links index the slots of aligned chunks, instead of
+  // pointing to nodes, which halves their size on 64-bit targets; counted
+  // nodes cache the sizes of their subtrees, for order statistics
+  using link_type = Link;
+  static constexpr bool counted{Counted};
+};
+
+}
+
 namespace xsg::detail
 {
 
@@ -41,20 +55,145 @@ inline auto assign(auto& ...a) noexcept
   return [&](auto const ...b) noexcept { assign((a = b)...); };
 }
 
-inline auto conv(auto const ...n) noexcept
+template <typename T>
+union slot
+{ // storage of a pooled node, or a free list link
+  slot* n_;
+  alignas(T) std::byte t_[sizeof(T)];
+};
+
+template <typename T>
+concept Indexed = std::is_same_v<decltype(T::l_), std::uint32_t>;
+
+template <typename T>
+concept Counted = std::is_same_v<decltype(T::s_), size_type>;
+
+template <typename T>
+struct slab
+{ // nodes live in aligned chunks, the chunk header leads to the chunk
+  // table, indexed links xor 1-based 32-bit slot indices
+  struct stack
+  { // a free list
+    slot<T>* s_; // top slot
+    size_type n_; // length
+  };
+
+  struct header
+  {
+    header* h0_; // header of chunk 0, the owner of the chunk table
+    slot<T>** t_; // chunk table, chunk 0 only
+    size_type n_; // chunk table capacity, chunk 0 only
+    size_type i_; // chunk number
+    stack* f_; // free list of the owning pool, null once orphaned
+    size_type l_; // live nodes
+  };
+
+  static constexpr size_type align{
+    std::bit_ceil(std::max(size_type(4096), 64 * sizeof(slot<T>)))
+  };
+
+  static constexpr size_type offset{
+    (sizeof(header) + alignof(slot<T>) - 1) / alignof(slot<T>) *
+    alignof(slot<T>)
+  };
+
+  static constexpr size_type N{(align - offset) / sizeof(slot<T>)};
+
+  struct alignas(align) chunk { std::byte b_[align]; };
+
+  static auto head(void const* const p) noexcept
+  {
+    return reinterpret_cast<header*>(std::uintptr_t(p) & ~(align - 1));
+  }
+
+  static auto slots(header* const h) noexcept
+  {
+    return reinterpret_cast<slot<T>*>(reinterpret_cast<std::byte*>(h) +
+      offset);
+  }
+
+  static std::uint32_t index(T const* const t) noexcept
+  { // bit 0 is left free for the direction tag
+    if (t)
+    {
+      auto const h(head(t));
+
+      return (h->i_ * N +
+        (reinterpret_cast<slot<T> const*>(t) - slots(h)) + 1) << 1;
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  static auto node(auto const x, std::uint32_t i) noexcept
+  { // x is any node of the same pool
+    using pointer = std::remove_const_t<decltype(x)>;
+
+    if (i >>= 1; i--)
+    {
+      return pointer(
+        static_cast<void*>(head(x)->h0_->t_[i / N][i % N].t_)
+      );
+    }
+    else
+    {
+      return pointer{};
+    }
+  }
+};
+
+inline auto conv(auto const n, auto const ...m) noexcept
 {
-  return (std::uintptr_t(n) ^ ...);
+  using node_t = std::remove_cv_t<std::remove_pointer_t<decltype(n)>>;
+
+  if constexpr(Indexed<node_t>)
+  {
+    return (slab<node_t>::index(n) ^ ... ^ slab<node_t>::index(m));
+  }
+  else
+  {
+    return (std::uintptr_t(n) ^ ... ^ std::uintptr_t(m));
+  }
+}
+
+inline auto node_of(auto const x, auto const l) noexcept
+{ // the node, that the link value l refers to, x is any node of the tree
+  using node_t = std::remove_cv_t<std::remove_pointer_t<decltype(x)>>;
+
+  if constexpr(Indexed<node_t>)
+  {
+    return slab<node_t>::node(x, l);
+  }
+  else
+  {
+    return std::remove_const_t<decltype(x)>(l & ~decltype(l)(1));
+  }
+}
+
+inline bool is_left(auto const n) noexcept
+{ // bit 0 of l_ tags left children
+  return n->l_ & 1;
+}
+
+inline bool is_marked(auto const n) noexcept
+{ // bit 0 of r_ marks tombstones, links never set it
+  return n->r_ & 1;
 }
 
+inline void mark(auto const n) noexcept { n->r_ |= 1; }
+inline void unmark(auto const n) noexcept { n->r_ &= ~decltype(n->r_)(1); }
+
 //
 inline auto left_node(auto const n, decltype(n) p) noexcept
 {
-  return std::remove_const_t<decltype(n)>(conv(p) ^ n->l_);
+  return node_of(n, conv(p) ^ n->l_);
 }
 
 inline auto right_node(auto const n, decltype(n) p) noexcept
 {
-  return std::remove_const_t<decltype(n)>(conv(p) ^ n->r_);
+  return node_of(n, conv(p) ^ n->r_);
 }
 
 inline auto first_node(auto n, decltype(n) p) noexcept
@@ -71,11 +210,20 @@ inline auto last_node(auto n, decltype(n) p) noexcept
   return std::pair(n, p);
 }
 
+inline auto first_pair(auto const n) noexcept
+{ // n is the first node or null, its null left link encodes the parent
+  return std::pair(n, n ? left_node(n, {}) : n);
+}
+
+inline auto last_pair(auto const n) noexcept
+{ // n is the last node or null, its null right link encodes the parent
+  return std::pair(n, n ? right_node(n, {}) : n);
+}
+
 //
 inline auto next_node(auto n, decltype(n) p) noexcept
 {
   using pointer = std::remove_cvref_t<decltype(n)>;
-  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
 
   if (auto const r(right_node(n, p)); r)
   {
@@ -83,9 +231,9 @@ inline auto next_node(auto n, decltype(n) p) noexcept
   }
   else
   {
-    for (auto const& key(n->key()); p;)
+    while (p)
     {
-      if (node::cmp(key, p->key()) < 0)
+      if (is_left(n))
       {
         return std::pair(p, left_node(p, n));
       }
@@ -101,7 +249,6 @@ inline auto next_node(auto n, decltype(n) p) noexcept
 
 inline auto prev_node(auto n, decltype(n) p) noexcept
 {
-  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
   using pointer = std::remove_cvref_t<decltype(n)>;
 
   if (auto const l(left_node(n, p)); l)
@@ -110,9 +257,9 @@ inline auto prev_node(auto n, decltype(n) p) noexcept
   }
   else
   {
-    for (auto const& key(n->key()); p;)
+    while (p)
     {
-      if (node::cmp(key, p->key()) < 0)
+      if (is_left(n))
       {
         assign(n, p)(p, left_node(p, n));
       }
@@ -135,418 +282,2177 @@ inline size_type height(auto const n, decltype(n) p) noexcept
     size_type{};
 }
 
+inline size_type weight(auto const n) noexcept
+{ // the cached size of the subtree rooted at the Counted node n
+  return n ? n->s_ : 0;
+}
+
+inline void reweigh(auto const n, decltype(n) l, decltype(n) r) noexcept
+{ // l and r are the children of n
+  using node_t = std::remove_pointer_t<std::remove_const_t<decltype(n)>>;
+
+  if constexpr(Counted<node_t>) n->s_ = 1 + weight(l) + weight(r);
+}
+
 inline size_type size(auto const n, decltype(n) p) noexcept
 {
-  return n ? 1 + size(left_node(n, p), n) + size(right_node(n, p), n) : 0;
+  using node_t = std::remove_cv_t<std::remove_pointer_t<decltype(n)>>;
+
+  if constexpr(Counted<node_t>)
+  {
+    return weight(n);
+  }
+  else
+  {
+    return n ? 1 + size(left_node(n, p), n) + size(right_node(n, p), n) : 0;
+  }
+}
+
+inline bool right_deeper(auto l, decltype(l) r, decltype(l) const n) noexcept
+{ // is the successor of n deeper than its predecessor? l and r are the
+  // children of n, both paths are walked in lockstep
+  for (auto lp(n), rp(n);;)
+  {
+    auto const ln(right_node(l, lp)), rn(left_node(r, rp));
+
+    if (!rn) return false; else if (!ln) return true;
+
+    assign(lp, l, rp, r)(l, ln, r, rn);
+  }
+}
+
+template <class A>
+constexpr size_type max_depth(size_type const n) noexcept
+{ // floor(log_{1/A}(n)), depth bound of an A-height-balanced tree
+  static_assert(std::ratio_less_v<std::ratio<1, 2>, A> &&
+    std::ratio_less_v<A, std::ratio<1>>, "alpha must lie in (1/2, 1)");
+
+  size_type h{};
+
+  for (double m(n); (m *= double(A::num) / A::den) >= 1.; ++h);
+
+  return h;
+}
+
+template <class A>
+constexpr bool unbalanced(size_type const s, size_type const sl,
+  size_type const sr) noexcept
+{ // is either child of an s node subtree heavier than A * s
+  return (A::den * sl > A::num * s) || (A::den * sr > A::num * s);
 }
 
 //
-inline void destroy(auto const n, decltype(n) p)
-  noexcept(noexcept(delete n))
-{
+inline void destroy(auto const n, decltype(n) p, auto const& ...f) noexcept
+{ // run the destructors, the storage belongs to a pool, f(n) may return
+  // it
   if (n)
   {
-    destroy(left_node(n, p), n);
-    destroy(right_node(n, p), n);
+    destroy(left_node(n, p), n, f...);
+    destroy(right_node(n, p), n, f...);
 
-    delete n;
+    std::destroy_at(n); (f(n), ...);
   }
 }
 
-inline auto equal_range(auto n, decltype(n) p, auto const& k) noexcept
-  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
-{
-  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
-
-  decltype(n) gn{}, gp{};
+inline auto clone(auto& na, auto const n, decltype(n) p,
+  std::remove_const_t<decltype(n)> const q)
+  noexcept(noexcept(na.create(std::as_const(*n)))) ->
+  std::remove_const_t<decltype(n)>
+{ // copy the subtree shape, q is the parent of the copy
+  std::remove_const_t<decltype(n)> c{};
 
-  while (n)
+  if (n)
   {
-    if (auto const c(node::cmp(k, n->key())); c < 0)
-    {
-      assign(gn, gp, n, p)(n, p, left_node(n, p), n);
-    }
-    else if (c > 0)
-    {
-      assign(n, p)(right_node(n, p), n);
-    }
-    else [[unlikely]]
-    {
-      if (auto const r(right_node(n, p)); r)
-      {
-        std::tie(gn, gp) = first_node(r, n);
-      }
+    c = na.create(std::as_const(*n));
 
-      break;
-    }
+    auto const l(clone(na, left_node(n, p), n, c));
+    auto const r(clone(na, right_node(n, p), n, c));
+
+    assign(c->l_, c->r_)(conv(l, q) | is_left(n), conv(r, q));
   }
 
-  return std::pair(
-      n ? std::pair(n, p) : std::pair(gn, gp),
-      std::pair(gn, gp)
-    );
+  return c;
 }
 
-inline auto find(auto n, decltype(n) p, auto const& k) noexcept
-  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
-{
-  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
+template <class P>
+using link_t = typename P::link_type;
 
-  while (n)
+struct nocount
+{
+  constexpr nocount(size_type) noexcept { }
+};
+
+template <class P>
+using count_t = std::conditional_t<P::counted, size_type, nocount>;
+
+template <typename T, class A>
+class pool
+{ // nodes are carved out of aligned chunks, the header of a chunk counts
+  // its live nodes and leads to the free list of the owning pool; nodes
+  // may pass to pools with equal allocators, or to node handles, and their
+  // slots return to the owner, once destroyed; a chunk, that still holds
+  // such nodes, outlives its pool and is freed along with its last node;
+  // pools, that exchanged nodes, must not be used concurrently
+  using slot_t = slot<T>;
+  using slab_t = slab<T>;
+  using header_t = typename slab_t::header;
+  using chunk_t = typename slab_t::chunk;
+  using stack_t = typename slab_t::stack;
+
+  template <typename U>
+  using alloc_t = typename std::allocator_traits<A>::template rebind_alloc<U>;
+  template <typename U>
+  using traits_t = std::allocator_traits<alloc_t<U>>;
+
+  [[no_unique_address]] alloc_t<slot_t> a_;
+
+  slot_t* c_{}; // slots of the newest chunk
+  stack_t* f_{}; // free list, the chunk headers refer to it
+  header_t* h0_{}; // header of chunk 0
+  size_type k_{}, u_{}; // chunk count, slots used from c_
+  size_type e_{}; // chunks freed by sweep(), null in the chunk table
+  size_type w_{slab_t::N}; // free slots, that trigger a sweep()
+  size_type sz_{}; // live nodes
+  bool x_{}; // have nodes passed to or from other pools?
+
+  static void deallocate(auto const& a, header_t* const h) noexcept
   {
-    if (auto const c(node::cmp(k, n->key())); c < 0)
-    {
-      assign(n, p)(left_node(n, p), n);
-    }
-    else if (c > 0)
-    {
-      assign(n, p)(right_node(n, p), n);
-    }
-    else [[unlikely]]
+    alloc_t<chunk_t> ca(a);
+    traits_t<chunk_t>::deallocate(ca, reinterpret_cast<chunk_t*>(h), 1);
+  }
+
+  void forget() noexcept
+  { // free the free list, no chunk may refer to it
+    if (f_)
     {
-      break;
+      alloc_t<stack_t> fa(a_);
+      traits_t<stack_t>::deallocate(fa, std::exchange(f_, nullptr), 1);
     }
   }
 
-  return std::pair(n, p);
-}
-
-inline auto erase(auto& r0, auto const pp, decltype(pp) p, decltype(pp) n,
-  std::uintptr_t* const q)
-  noexcept(noexcept(delete r0))
-{
-  auto [nnn, nnp](next_node(n, p));
+  void sweep() noexcept
+  { // free the empty chunks, but chunk 0, which holds the chunk table,
+    // their slots leave the free list, the chunk table keeps null holes,
+    // as indexed links refer to chunk numbers; no destroyed node may be
+    // used to find the chunk table afterwards
+    slot_t* s{};
+    size_type n{};
 
-  // pp - p - n - lr
-  if (auto const l(left_node(n, p)), r(right_node(n, p)); l && r)
-  {
-    if (size(l, n) < size(r, n)) // erase from right side?
+    for (auto q(f_->s_); q;)
     {
-      auto const [fnn, fnp](first_node(r, n));
+      auto const h(slab_t::head(q));
+      auto const p(q);
 
-      if (fnn == nnn)
-      {
-        nnp = p;
-      }
+      q = q->n_;
 
-      q ? *q = conv(fnn, pp) : bool(r0 = fnn);
+      if (h->l_ || !h->i_) p->n_ = s, s = p, ++n;
+    }
 
-      // convert and attach l to fnn
-      fnn->l_ = conv(l, p); 
+    *f_ = {s, n};
 
+    for (auto const t(h0_->t_); auto& c: std::span(t + 1, t + k_))
+    {
+      if (c && !slab_t::head(c)->l_)
       {
-        auto const nfnn(conv(n, fnn));
-        l->l_ ^= nfnn; l->r_ ^= nfnn;
-      }
+        if (c == c_) c_ = {};
 
-      if (r == fnn)
-      {
-        r->r_ ^= conv(n, p);
+        deallocate(a_, slab_t::head(std::exchange(c, nullptr))); ++e_;
       }
-      else
-      {
-        // attach right node of fnn to parent left
-        {
-          auto const fnpp(left_node(fnp, fnn));
-          auto const rn(right_node(fnn, fnp));
-
-          fnp->l_ = conv(rn, fnpp);
-
-          if (rn)
-          {
-            auto const fnnfnp(conv(fnn, fnp));
-            rn->l_ ^= fnnfnp; rn->r_ ^= fnnfnp;
-          }
-        }
+    }
 
-        // convert and attach r to fnn
-        fnn->r_ = conv(r, p);
+    w_ = 2 * n + slab_t::N;
+  }
 
-        auto const nfnn(conv(n, fnn));
-        r->l_ ^= nfnn; r->r_ ^= nfnn;
-      }
+  void reserve(size_type const k)
+  { // room for k chunks in the chunk table
+    if constexpr(Indexed<T>)
+    {
+      if (k * slab_t::N > ~std::uint32_t{} >> 1) throw std::bad_alloc();
     }
-    else // erase from the left side
+
+    if (k > h0_->n_)
     {
-      auto const [lnn, lnp](last_node(l, n));
+      alloc_t<slot_t*> ta(a_);
 
-      if (r == nnn)
+      auto const n(std::max({k, 2 * h0_->n_, size_type(8)}));
+      auto const t(traits_t<slot_t*>::allocate(ta, n));
+
+      if (h0_->n_)
       {
-        nnp = lnn;
+        std::copy(h0_->t_, h0_->t_ + k_, t);
+        traits_t<slot_t*>::deallocate(ta, h0_->t_, h0_->n_);
       }
 
-      q ? *q = conv(lnn, pp) : bool(r0 = lnn);
+      assign(h0_->t_, h0_->n_)(t, n);
+    }
+  }
 
-      // convert and attach r to lnn
-      lnn->r_ = conv(r, p); 
+  void grow()
+  { // aligned chunks, so that a node can find its chunk header
+    if (!f_)
+    { // the chunk headers refer to the free list
+      alloc_t<stack_t> fa(a_);
 
-      {
-        auto const nlnn(conv(n, lnn));
-        r->l_ ^= nlnn; r->r_ ^= nlnn;
-      }
+      f_ = ::new (static_cast<void*>(traits_t<stack_t>::allocate(fa, 1)))
+        stack_t{};
+    }
 
-      if (l == lnn)
-      {
-        l->l_ ^= conv(n, p);
-      }
-      else
-      {
-        {
-          auto const lnpp(right_node(lnp, lnn));
-          auto const ln(left_node(lnn, lnp));
+    alloc_t<chunk_t> ca(a_);
+    auto const h(reinterpret_cast<header_t*>(
+      traits_t<chunk_t>::allocate(ca, 1)));
 
-          lnp->r_ = conv(ln, lnpp);
+    auto i(k_); // a hole, if any, is reused
 
-          if (ln)
-          {
-            auto const lnnlnp(conv(lnn, lnp));
-            ln->l_ ^= lnnlnp; ln->r_ ^= lnnlnp;
-          }
-        }
+    if (e_) for (i = 1; h0_->t_[i]; ++i);
 
-        // convert and attach l to lnn
-        lnn->l_ = conv(l, p);
+    ::new (static_cast<void*>(h)) header_t{k_ ? h0_ : h, {}, {}, i, f_, {}};
 
-        auto const nlnn(conv(n, lnn));
-        l->l_ ^= nlnn; l->r_ ^= nlnn;
-      }
-    }
-  }
-  else
-  {
-    auto const lr(l ? l : r);
+    if (!k_) h0_ = h;
 
-    if (lr)
+    if (!e_)
     {
-      if (lr == nnn)
+      try
       {
-        nnp = p;
+        reserve(k_ + 1);
       }
+      catch (...)
+      {
+        if (!k_) h0_ = {};
 
-      auto const np(conv(n, p));
-      lr->l_ ^= np; lr->r_ ^= np;
+        deallocate(a_, h);
+        throw;
+      }
     }
 
-    q ? *q = conv(lr, pp) : bool(r0 = lr);
+    h0_->t_[i] = c_ = slab_t::slots(h); u_ = {};
+    i == k_ ? ++k_ : --e_;
   }
 
-  delete n;
+public:
+  using allocator_type = A;
 
-  return std::pair(nnn, nnp);
-}
+  pool() = default;
 
-inline auto erase(auto& r0, auto const& k)
-  noexcept(noexcept(delete r0))
-  requires(Comparable<decltype(r0->cmp), decltype(k), decltype(r0->key())>)
-{
-  using pointer = std::remove_cvref_t<decltype(r0)>;
-  using node = std::remove_pointer_t<pointer>;
+  explicit pool(A const& a) noexcept: a_(a) { }
+
+  pool(pool const&) = delete;
+  pool(pool&&) = delete;
+
+  ~pool() noexcept { release(); forget(); }
+
+  //
+  pool& operator=(pool const&) = delete;
+  pool& operator=(pool&&) = delete;
+
+  //
+  A get_allocator() const noexcept { return A(a_); }
 
-  std::uintptr_t* q{};
+  auto size() const noexcept { return sz_; }
 
-  for (pointer n(r0), p{}, pp{}; n;)
+  T* create(auto&& ...a)
   {
-    if (auto const c(node::cmp(k, n->key())); c < 0)
+    slot_t* s;
+
+    if (f_ && f_->s_)
     {
-      assign(pp, p, n, q)(p, n, left_node(n, p), &n->l_);
+      s = f_->s_; f_->s_ = s->n_; --f_->n_;
     }
-    else if (c > 0)
+    else
     {
-      assign(pp, p, n, q)(p, n, right_node(n, p), &n->r_);
+      if (!c_ || (u_ == slab_t::N)) grow();
+
+      s = &c_[u_++];
     }
-    else [[unlikely]]
+
+    try
     {
-      return erase(r0, pp, p, n, q);
-    }
-  }
+      T* t;
 
-  return std::pair(pointer{}, pointer{});
-}
+      if constexpr(std::uses_allocator_v<T, alloc_t<slot_t>>)
+      { // the node allocates its values with ours
+        t = ::new (static_cast<void*>(s)) T(std::allocator_arg, a_,
+          std::forward<decltype(a)>(a)...);
+      }
+      else
+      {
+        t = ::new (static_cast<void*>(s)) T(std::forward<decltype(a)>(a)...);
+      }
 
-inline auto erase(auto& r0, auto const n, decltype(n) p)
-  noexcept(noexcept(delete r0))
-{
-  using pointer = std::remove_cvref_t<decltype(r0)>;
-  using node = std::remove_pointer_t<pointer>;
+      ++sz_; ++slab_t::head(t)->l_;
 
-  pointer pp{};
-  std::uintptr_t* q{};
+      return t;
+    }
+    catch (...)
+    { // the slot goes onto the free list
+      f_->s_ = ::new (static_cast<void*>(s)) slot_t{f_->s_}; ++f_->n_;
 
-  if (p)
-  {
-    if (node::cmp(n->key(), p->key()) < 0)
+      throw;
+    }
+  }
+
+  static void drop(auto const& a, T* const t) noexcept
+  { // return the slot of the destroyed node t to the pool owning its
+    // chunk, an orphaned chunk is freed with a, along with its last node
+    auto const h(slab_t::head(t));
+
+    if (--h->l_; h->f_)
     {
-      assign(pp, q)(left_node(p, n), &p->l_);
+      h->f_->s_ = ::new (static_cast<void*>(t)) slot_t{h->f_->s_};
+      ++h->f_->n_;
     }
-    else
+    else if (!h->l_)
     {
-      assign(pp, q)(right_node(p, n), &p->r_);
+      deallocate(a, h);
     }
   }
 
-  return erase(r0, pp, p, n, q);
+  void destroy(T* const t) noexcept
+  {
+    std::destroy_at(t); --sz_; drop(a_, t);
+  }
+
+  // a detached node is not counted, but keeps its slot
+  void attach(T*) noexcept { ++sz_; }
+  void detach(T*) noexcept { --sz_; }
+
+  void clear(T* const r) noexcept
+  { // destroy the tree rooted at r, then release the chunks, the nodes
+    // are dropped one by one, if some may live in chunks of other pools
+    if (x_)
+    {
+      detail::destroy(r, {}, [&](T* const t) noexcept { drop(a_, t); });
+    }
+    else if constexpr(!std::is_trivially_destructible_v<T>)
+    {
+      detail::destroy(r, {});
+    }
+
+    release();
+  }
+
+  void release() noexcept
+  { // free the chunks, but orphan those holding nodes, that passed to other
+    // pools or node handles
+    if (k_)
+    {
+      auto const [t, n](std::pair(h0_->t_, h0_->n_));
+
+      for (auto k(k_); k; --k)
+      {
+        if (!t[k - 1])
+        {
+        }
+        else if (auto const h(slab_t::head(t[k - 1])); x_ && h->l_)
+        {
+          h->f_ = {};
+        }
+        else
+        {
+          deallocate(a_, h);
+        }
+      }
+
+      alloc_t<slot_t*> ta(a_);
+      traits_t<slot_t*>::deallocate(ta, t, n);
+
+      *f_ = {};
+    }
+
+    c_ = {}; h0_ = {}; k_ = u_ = e_ = sz_ = {}; w_ = slab_t::N; x_ = {};
+  }
+
+  A lend() noexcept
+  { // a node leaves for a node handle, which frees it with our allocator
+    x_ = true; return A(a_);
+  }
+
+  bool owns(T* const t) const noexcept
+  { // is t in one of our chunks?
+    return f_ && (slab_t::head(t)->f_ == f_);
+  }
+
+  bool sharable(A const& a) const noexcept
+  { // can nodes, allocated with a, be attached? indexed links can not
+    // leave their pool
+    if constexpr(Indexed<T>)
+    {
+      return false;
+    }
+    else
+    {
+      return traits_t<slot_t>::is_always_equal::value ||
+        (a_ == alloc_t<slot_t>(a));
+    }
+  }
+
+  bool sharable(pool const& o) const noexcept { return sharable(A(o.a_)); }
+
+  // nodes of other pools come in
+  void share() noexcept { x_ = true; }
+  void share(pool& o) noexcept { x_ = o.x_ = true; }
+
+  static constexpr bool always_stealable{
+    traits_t<slot_t>::propagate_on_container_move_assignment::value ||
+    traits_t<slot_t>::is_always_equal::value
+  };
+
+  bool stealable(pool const& o) const noexcept
+  { // can o's chunks be taken over by a move assignment?
+    return always_stealable || (a_ == o.a_);
+  }
+
+  void steal(pool& o) noexcept
+  { // the chunks of this pool must have been released, those of o keep
+    // referring to o's free list
+    forget();
+
+    if constexpr(
+      traits_t<slot_t>::propagate_on_container_move_assignment::value)
+    {
+      a_ = std::move(o.a_);
+    }
+
+    assign(c_, f_, h0_, k_, u_, e_, w_, sz_, x_)(
+      o.c_, o.f_, o.h0_, o.k_, o.u_, o.e_, o.w_, o.sz_, o.x_);
+    o.c_ = {}; o.f_ = {}; o.h0_ = {};
+    o.k_ = o.u_ = o.e_ = o.sz_ = {}; o.w_ = slab_t::N; o.x_ = {};
+  }
+
+  void reserve(pool const& o)
+  { // room for adopting o's chunks, adopt(o) then does not throw
+    if (k_ && o.k_) reserve(k_ + o.k_);
+  }
+
+  bool adoptable(pool const& o) const noexcept
+  { // can o's chunks be added to ours?
+    return traits_t<slot_t>::is_always_equal::value || (a_ == o.a_);
+  }
+
+  void adopt(pool& o)
+  { // take over o's chunks and append them to ours, the adopted nodes
+    // keep their addresses, but indexed links must be rebuilt
+    if (!k_)
+    { // o's free list comes along
+      std::swap(f_, o.f_);
+      assign(c_, h0_, k_, u_, e_, w_)(o.c_, o.h0_, o.k_, o.u_, o.e_, o.w_);
+    }
+    else if (o.k_)
+    {
+      reserve(k_ + o.k_);
+
+      auto const [t, n](std::pair(o.h0_->t_, o.h0_->n_));
+
+      for (size_type i{}; i != o.k_; ++i)
+      {
+        if ((h0_->t_[k_ + i] = t[i]))
+        {
+          auto const h(slab_t::head(t[i]));
+
+          *h = {h0_, {}, {}, k_ + i, f_, h->l_};
+        }
+      }
+
+      {
+        alloc_t<slot_t*> ta(a_);
+        traits_t<slot_t*>::deallocate(ta, t, n);
+      }
+
+      // o's newest chunk becomes ours, our unused slots are freed
+      if (c_)
+      {
+        for (; u_ != slab_t::N; ++u_, ++f_->n_)
+        {
+          f_->s_ = ::new (static_cast<void*>(&c_[u_])) slot_t{f_->s_};
+        }
+      }
+
+      k_ += o.k_; e_ += o.e_; c_ = o.c_; u_ = o.u_;
+
+      if (auto f(o.f_->s_); f)
+      {
+        for (; f->n_; f = f->n_);
+
+        f->n_ = f_->s_; f_->s_ = o.f_->s_; f_->n_ += o.f_->n_;
+        *o.f_ = {};
+      }
+    }
+
+    sz_ += o.sz_; x_ = x_ || o.x_;
+
+    o.c_ = {}; o.h0_ = {};
+    o.k_ = o.u_ = o.e_ = o.sz_ = {}; o.w_ = slab_t::N; o.x_ = {};
+
+    // adopting chunks, while erasing, piles up free slots
+    if (f_ && (f_->n_ > w_)) sweep();
+  }
+
+  void swap(pool& o) noexcept
+  { // unequal allocators, that do not propagate, are not supported
+    if constexpr(traits_t<slot_t>::propagate_on_container_swap::value)
+    {
+      using std::swap;
+      swap(a_, o.a_);
+    }
+    else
+    {
+      assert(traits_t<slot_t>::is_always_equal::value || (a_ == o.a_));
+    }
+
+    assign(c_, f_, h0_, k_, u_, e_, w_, sz_, x_,
+      o.c_, o.f_, o.h0_, o.k_, o.u_, o.e_, o.w_, o.sz_, o.x_)(
+      o.c_, o.f_, o.h0_, o.k_, o.u_, o.e_, o.w_, o.sz_, o.x_,
+      c_, f_, h0_, k_, u_, e_, w_, sz_, x_
+    );
+  }
+};
+
+inline auto equal_range(auto n, decltype(n) p, auto const& k) noexcept
+  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
+{
+  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
+
+  decltype(n) gn{}, gp{};
+
+  while (n)
+  {
+    if (auto const c(node::cmp(k, n->key())); c < 0)
+    {
+      assign(gn, gp, n, p)(n, p, left_node(n, p), n);
+    }
+    else if (c > 0)
+    {
+      assign(n, p)(right_node(n, p), n);
+    }
+    else [[unlikely]]
+    {
+      if (auto const r(right_node(n, p)); r)
+      {
+        std::tie(gn, gp) = first_node(r, n);
+      }
+
+      break;
+    }
+  }
+
+  return std::pair(
+      n ? std::pair(n, p) : std::pair(gn, gp),
+      std::pair(gn, gp)
+    );
+}
+
+inline auto find(auto n, decltype(n) p, auto const& k) noexcept
+  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
+{
+  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
+
+  while (n)
+  {
+    if (auto const c(node::cmp(k, n->key())); c < 0)
+    {
+      assign(n, p)(left_node(n, p), n);
+    }
+    else if (c > 0)
+    {
+      assign(n, p)(right_node(n, p), n);
+    }
+    else [[unlikely]]
+    {
+      break;
+    }
+  }
+
+  return std::pair(n, p);
+}
+
+inline auto climb(auto n, decltype(n) p, auto const& k) noexcept
+  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
+{ // climb from the finger (n, p), until the subtree of n brackets k, the
+  // ancestor (gn, gp) bounds the subtree from above, if it is known
+  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
+
+  decltype(n) gn{}, gp{};
+
+  if (auto const c(node::cmp(k, n->key())); c < 0)
+  {
+    while (p)
+    {
+      auto const t(is_left(n));
+      auto const pp(t ? left_node(p, n) : right_node(p, n));
+
+      if (!t)
+      { // p bounds the subtree from below
+        if (auto const c(node::cmp(k, p->key())); c > 0)
+        {
+          break;
+        }
+        else if (c == 0)
+        {
+          assign(n, p)(p, pp); break;
+        }
+      }
+
+      assign(n, p)(p, pp);
+    }
+  }
+  else if (c > 0)
+  {
+    while (p)
+    {
+      auto const t(is_left(n));
+      auto const pp(t ? left_node(p, n) : right_node(p, n));
+
+      if (t)
+      { // p bounds the subtree from above
+        if (auto const c(node::cmp(k, p->key())); c < 0)
+        {
+          assign(gn, gp)(p, pp); break;
+        }
+        else if (c == 0)
+        {
+          assign(n, p)(p, pp); break;
+        }
+      }
+
+      assign(n, p)(p, pp);
+    }
+  }
+
+  return std::tuple(n, p, gn, gp);
+}
+
+inline auto find_from(auto const n, decltype(n) p, auto const& k) noexcept
+{ // finger search, O(log d) in the distance d between n and k
+  auto const [cn, cp, gn, gp](climb(n, p, k));
+
+  return find(cn, cp, k);
+}
+
+inline auto lower_bound_from(auto const n, decltype(n) p, auto const& k)
+  noexcept
+{
+  auto const [cn, cp, gn, gp](climb(n, p, k));
+  auto const [l, u](equal_range(cn, cp, k));
+
+  return std::get<0>(l) ? l : std::pair(gn, gp);
+}
+
+inline auto select(auto n, decltype(n) p, size_type k) noexcept
+{ // the Counted node of in-order rank k, or null
+  while (n)
+  {
+    auto const l(left_node(n, p));
+
+    if (auto const s(weight(l)); k < s)
+    {
+      assign(n, p)(l, n);
+    }
+    else if (k -= s)
+    {
+      --k; assign(n, p)(right_node(n, p), n);
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return std::pair(n, p);
+}
+
+inline size_type rank(auto n, decltype(n) p) noexcept
+{ // the number of Counted nodes preceding n
+  auto r(weight(left_node(n, p)));
+
+  while (p)
+  {
+    if (is_left(n))
+    {
+      assign(n, p)(p, left_node(p, n));
+    }
+    else
+    {
+      auto const pp(right_node(p, n));
+
+      r += 1 + weight(left_node(p, pp));
+      assign(n, p)(p, pp);
+    }
+  }
+
+  return r;
+}
+
+inline size_type rank(auto n, decltype(n) p, auto const& k) noexcept
+  requires(Comparable<decltype(n->cmp), decltype(k), decltype(n->key())>)
+{ // the number of Counted nodes with keys less than k
+  using node = std::remove_const_t<std::remove_pointer_t<decltype(n)>>;
+
+  size_type r{};
+
+  while (n)
+  {
+    if (node::cmp(k, n->key()) > 0)
+    {
+      r += 1 + weight(left_node(n, p));
+      assign(n, p)(right_node(n, p), n);
+    }
+    else
+    {
+      assign(n, p)(left_node(n, p), n);
+    }
+  }
+
+  return r;
+}
+
+inline auto erase(auto& r0, auto& na, auto const p, decltype(p) n,
+  decltype(p->l_)* const q) noexcept
+{ // q points to the link of p, that leads to n, or is null
+  using node_t = std::remove_pointer_t<std::remove_const_t<decltype(p)>>;
+
+  auto [nnn, nnp](next_node(n, p));
+
+  auto const t(is_left(n));
+
+  if constexpr(Counted<node_t>)
+  { // the ancestors of n lose a node
+    for (auto a(n), b(p); b;)
+    {
+      --b->s_;
+      assign(a, b)(b, is_left(a) ? left_node(b, a) : right_node(b, a));
+    }
+  }
+
+  // p - n - lr
+  if (auto const l(left_node(n, p)), r(right_node(n, p)); l && r)
+  {
+    if (right_deeper(l, r, n)) // erase from right side?
+    {
+      auto const [fnn, fnp](first_node(r, n));
+
+      if constexpr(Counted<node_t>)
+      { // fnn takes the place of n
+        for (auto a(r), b(n); a != fnn; assign(a, b)(left_node(a, b), a))
+        {
+          --a->s_;
+        }
+
+        fnn->s_ = n->s_ - 1;
+      }
+
+      if (fnn == nnn)
+      {
+        nnp = p;
+      }
+
+      q ? *q ^= conv(n, fnn) : bool(r0 = fnn);
+
+      // convert and attach l to fnn
+      fnn->l_ = conv(l, p) | t;
+
+      {
+        auto const nfnn(conv(n, fnn));
+        l->l_ ^= nfnn; l->r_ ^= nfnn;
+      }
+
+      if (r == fnn)
+      {
+        r->r_ ^= conv(n, p);
+      }
+      else
+      {
+        // attach right node of fnn to parent left
+        {
+          auto const rn(right_node(fnn, fnp));
+
+          fnp->l_ ^= conv(fnn, rn);
+
+          if (rn)
+          {
+            auto const fnnfnp(conv(fnn, fnp));
+            rn->l_ ^= fnnfnp | 1; rn->r_ ^= fnnfnp; // now a left child
+          }
+        }
+
+        // convert and attach r to fnn
+        fnn->r_ = conv(r, p);
+
+        auto const nfnn(conv(n, fnn));
+        r->l_ ^= nfnn; r->r_ ^= nfnn;
+      }
+    }
+    else // erase from the left side
+    {
+      auto const [lnn, lnp](last_node(l, n));
+
+      if constexpr(Counted<node_t>)
+      { // lnn takes the place of n
+        for (auto a(l), b(n); a != lnn; assign(a, b)(right_node(a, b), a))
+        {
+          --a->s_;
+        }
+
+        lnn->s_ = n->s_ - 1;
+      }
+
+      if (r == nnn)
+      {
+        nnp = lnn;
+      }
+
+      q ? *q ^= conv(n, lnn) : bool(r0 = lnn);
+
+      // convert and attach r to lnn
+      lnn->r_ = conv(r, p);
+
+      {
+        auto const nlnn(conv(n, lnn));
+        r->l_ ^= nlnn; r->r_ ^= nlnn;
+      }
+
+      if (l == lnn)
+      {
+        l->l_ ^= conv(n, p) | !t; // takes the place of n
+      }
+      else
+      {
+        {
+          auto const ln(left_node(lnn, lnp));
+
+          lnp->r_ ^= conv(lnn, ln);
+
+          if (ln)
+          {
+            auto const lnnlnp(conv(lnn, lnp));
+            ln->l_ ^= lnnlnp | 1; ln->r_ ^= lnnlnp; // now a right child
+          }
+        }
+
+        // convert and attach l to lnn
+        lnn->l_ = conv(l, p) | t;
+
+        auto const nlnn(conv(n, lnn));
+        l->l_ ^= nlnn; l->r_ ^= nlnn;
+      }
+    }
+  }
+  else
+  {
+    auto const lr(l ? l : r);
+
+    if (lr)
+    {
+      if (lr == nnn)
+      {
+        nnp = p;
+      }
+
+      auto const np(conv(n, p));
+      lr->l_ ^= np | (is_left(lr) != t); lr->r_ ^= np;
+    }
+
+    q ? *q ^= conv(n, lr) : bool(r0 = lr);
+  }
+
+  na.destroy(n);
+
+  return std::pair(nnn, nnp);
+}
+
+inline auto erase(auto& r0, auto& na, auto const& k) noexcept
+  requires(Comparable<decltype(r0->cmp), decltype(k), decltype(r0->key())>)
+{
+  using pointer = std::remove_cvref_t<decltype(r0)>;
+  using node = std::remove_pointer_t<pointer>;
+
+  decltype(r0->l_)* q{};
+
+  for (pointer n(r0), p{}; n;)
+  {
+    if (auto const c(node::cmp(k, n->key())); c < 0)
+    {
+      assign(p, n, q)(n, left_node(n, p), &n->l_);
+    }
+    else if (c > 0)
+    {
+      assign(p, n, q)(n, right_node(n, p), &n->r_);
+    }
+    else [[unlikely]]
+    {
+      return erase(r0, na, p, n, q);
+    }
+  }
+
+  return std::pair(pointer{}, pointer{});
+}
+
+inline auto erase(auto& r0, auto& na, auto const n, decltype(n) p)
+  noexcept
+{
+  return erase(r0, na, p, n, p ? is_left(n) ? &p->l_ : &p->r_ : nullptr);
+}
+
+template <typename T>
+struct scratch
+{ // optional reusable rebuild buffer, rebuilds also remove tombstones
+  std::unique_ptr<T*[]> a_;
+  size_type n_{};
+
+  bool e_{}; // erase marks tombstones
+  mutable size_type t_{}; // tombstones in the tree
+  mutable T* g_{}; // tombstones removed by rebuilds, chained through r_
+
+  void reset(size_type const n)
+  {
+    a_.reset(n ? new T*[n] : nullptr); n_ = n;
+  }
+};
+
+inline void flatten(auto const n, decltype(n) p, auto*& t) noexcept
+{ // chain the subtree in order, through the r_ links
+  if (n)
+  {
+    auto const l(left_node(n, p)), r(right_node(n, p));
+
+    flatten(l, n, t);
+
+    *t = conv(n); t = &n->r_;
+
+    flatten(r, n, t);
+  }
+}
+
+inline size_type prune(auto const n, decltype(n) p, auto*& t,
+  auto const& sb) noexcept
+{ // flatten, but pass the tombstones on to sb, return the nodes chained
+  if (n)
+  {
+    auto const l(left_node(n, p)), r(right_node(n, p));
+
+    auto k(prune(l, n, t, sb));
+
+    if (is_marked(n))
+    {
+      n->r_ = conv(sb.g_); sb.g_ = n; --sb.t_;
+    }
+    else
+    {
+      *t = conv(n); t = &n->r_; ++k;
+    }
+
+    return k + prune(r, n, t, sb);
+  }
+  else
+  {
+    return {};
+  }
+}
+
+inline auto gather(auto const n, decltype(n) p, auto b) noexcept ->
+  decltype(b)
+{ // store the subtree's nodes in order, starting at b, return the end
+  if (n)
+  {
+    b = gather(left_node(n, p), n, b);
+
+    *b++ = n;
+
+    b = gather(right_node(n, p), n, b);
+  }
+
+  return b;
+}
+
+inline auto build(auto const p, decltype(p) x, auto& h, size_type const sz,
+  decltype(p) q, auto& qp, auto const& f) noexcept ->
+  std::remove_const_t<decltype(p)>
+{ // consume sz nodes from the chain h, x being any of them, left subtrees
+  // are built with a null parent, that is patched, once it is known
+  std::remove_const_t<decltype(p)> n{};
+
+  if (sz)
+  {
+    auto const l(build(decltype(p){}, x, h, (sz - 1) / 2, q, qp, f));
+
+    n = node_of(x, h); h = n->r_;
+
+    if (n == q) qp = p;
+
+    if (l)
+    {
+      if (l == q) qp = n;
+
+      auto const c(conv(n));
+      l->l_ ^= c | 1; l->r_ ^= c; // tag the left child
+    }
+
+    auto const r(build(n, x, h, sz / 2, q, qp, f));
+
+    assign(n->l_, n->r_)(conv(l, p), conv(r, p));
+
+    reweigh(n, l, r); f(n, l, r);
+  }
+
+  return n;
+}
+
+inline auto build(auto const p, auto const a, decltype(a) b,
+  std::remove_reference_t<decltype(*a)> const q, auto& qp,
+  auto const& f) noexcept -> std::remove_reference_t<decltype(*a)>
+{ // build from the node array [a, b]
+  auto const m(std::midpoint(a, b));
+  auto const n(*m);
+
+  if (n == q) qp = p;
+
+  auto const l(a == m ? decltype(n){} : build(n, a, m - 1, q, qp, f));
+  auto const r(b == m ? decltype(n){} : build(n, m + 1, b, q, qp, f));
+
+  assign(n->l_, n->r_)(conv(l, p), conv(r, p));
+
+  if (l) l->l_ |= 1; // tag the left child
+
+  reweigh(n, l, r); f(n, l, r);
+
+  return n;
+}
+
+inline auto rebalance(auto const n, decltype(n) p, decltype(n) q, auto& qp,
+  size_type const sz, auto const& sb, auto const& f) noexcept
+{
+  if (sb.t_) [[unlikely]]
+  { // rebuild in place, without the tombstones
+    decltype(n->r_) h;
+    auto t(&h);
+
+    auto const k(prune(n, p, t, sb));
+
+    return build(p, n, h, k, q, qp, f);
+  }
+  else if (sz <= sb.n_)
+  { // use the scratch buffer
+    auto const a(sb.a_.get());
+
+    return build(p, a, gather(n, p, a) - 1, q, qp, f);
+  }
+  else
+  { // rebuild in place
+    decltype(n->r_) h;
+
+    {
+      auto t(&h);
+      flatten(n, p, t);
+    }
+
+    return build(p, n, h, sz, q, qp, f);
+  }
+}
+
+inline auto rebalance(auto const n, decltype(n) p, decltype(n) q, auto& qp,
+  size_type const sz, auto const& sb) noexcept
+{
+  return rebalance(n, p, q, qp, sz, sb, [](auto, auto, auto) noexcept {});
+}
+
+template <class A>
+inline bool shrunk(size_type const s, size_type const sz, size_type& ms)
+  noexcept
+{ // s and sz are node counts before and after an erase, ms is the peak
+  // node count since the last full rebuild, that is due, if true is returned
+  if (ms < s) ms = s;
+
+  return A::den * sz < A::num * ms ? ms = sz : false;
+}
+
+template <class A>
+inline auto emplace(auto& r, size_type const sz, auto const& sb,
+  auto const& k, auto const& create_node)
+  noexcept(noexcept(create_node({})))
+{
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r)>>;
+
+  struct S
+  {
+    enum Direction: bool { LEFT, RIGHT };
+
+    decltype(r) r_;
+    decltype(sb) sb_;
+    decltype(k) k_;
+    decltype(create_node) create_node_;
+
+    size_type const h_;
+
+    node_t* q_, *qp_;
+    bool s_;
+
+    explicit S(decltype(r) r, size_type const sz, decltype(sb) sb,
+      decltype(k) k, decltype(create_node) cn) noexcept:
+      r_(r), sb_(sb), k_(k), create_node_(cn),
+      h_(max_depth<A>(sz + 1))
+    {
+    }
+
+    auto count(node_t* const n, size_type const s) const noexcept
+    { // account for a node, inserted into the subtree of n
+      if constexpr(Counted<node_t>) n->s_ += s_;
+
+      return s;
+    }
+
+    void create(node_t* const n) noexcept(noexcept(create_node_({})))
+    {
+      assign(q_, qp_, s_)(create_node_(n), n, true);
+
+      if constexpr(Counted<node_t>) ++n->s_;
+    }
+
+    // returns the size of the subtree rooted at n, while searching for a
+    // scapegoat, 0 otherwise
+    size_type operator()(node_t* n, decltype(n) p, enum Direction const d,
+      size_type const h) noexcept(noexcept(create_node_({})))
+    {
+      size_type sl, sr;
+
+      if (auto const c(node_t::cmp(k_, n->key())); c < 0)
+      {
+        if (auto const l = left_node(n, p))
+        {
+          if (!(sl = count(n, (*this)(l, n, LEFT, h + 1)))) return {};
+        }
+        else
+        {
+          create(n);
+          n->l_ ^= conv(q_); q_->l_ |= 1;
+
+          if (h < h_) return {}; else sl = 1; // too deep?
+        }
+
+        sr = size(right_node(n, p), n);
+      }
+      else if (c > 0)
+      {
+        if (auto const r = right_node(n, p))
+        {
+          if (!(sr = count(n, (*this)(r, n, RIGHT, h + 1)))) return {};
+        }
+        else
+        {
+          create(n);
+          n->r_ ^= conv(q_);
+
+          if (h < h_) return {}; else sr = 1;
+        }
+
+        sl = size(left_node(n, p), n);
+      }
+      else [[unlikely]]
+      {
+        assign(q_, qp_, s_)(n, p, false);
+
+        return {};
+      }
+
+      //
+      if (auto const s(1 + sl + sr); unbalanced<A>(s, sl, sr))
+      {
+        if (auto const nn(rebalance(n, p, q_, qp_, s, sb_)); p)
+        {
+          d ? p->r_ ^= conv(n, nn) : (p->l_ ^= conv(n, nn), nn->l_ |= 1);
+        }
+        else
+        {
+          r_ = nn;
+        }
+
+        return {};
+      }
+      else
+      {
+        return s;
+      }
+    }
+  };
+
+  //
+  S s(r, sz, sb, k, create_node); s(r, {}, {}, {});
+
+  return std::tuple(s.q_, s.qp_, s.s_);
+}
+
+template <class A>
+inline auto emplace(auto& r, size_type const sz, auto const& sb,
+  auto const& k, auto const& create_node, auto const n, decltype(n) p,
+  decltype(n) l) noexcept(noexcept(create_node({})))
+{ // insert before the hint (n, p), if k fits there, otherwise descend from
+  // the root, n is null for end() hints, l is the last node
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r)>>;
+
+  auto const [a, ap](n ? prev_node(n, p) : last_pair(l));
+
+  if (n)
+  {
+    if (auto const c(node_t::cmp(k, n->key())); c > 0)
+    {
+      return emplace<A>(r, sz, sb, k, create_node);
+    }
+    else if (c == 0)
+    {
+      return std::tuple(n, p, false);
+    }
+  }
+
+  if (a)
+  {
+    if (auto const c(node_t::cmp(k, a->key())); c < 0)
+    {
+      return emplace<A>(r, sz, sb, k, create_node);
+    }
+    else if (c == 0)
+    {
+      return std::tuple(a, ap, false);
+    }
+  }
+
+  node_t* q, *qp;
+
+  if (n && !left_node(n, p))
+  {
+    q = create_node(qp = n);
+    n->l_ ^= conv(q); q->l_ |= 1;
+  }
+  else // a has no right child
+  {
+    q = create_node(qp = a);
+    a->r_ ^= conv(q);
+  }
+
+  size_type h{}; // depth of q
+
+  for (auto c(q), cp(qp); cp; ++h)
+  {
+    if constexpr(Counted<node_t>) ++cp->s_;
+
+    assign(c, cp)(cp, is_left(c) ? left_node(cp, c) : right_node(cp, c));
+  }
+
+  if (h > max_depth<A>(sz + 1))
+  { // search for a scapegoat on the way up
+    size_type sc(1); // size of the subtree rooted at c
+
+    for (node_t* c(q), *cp(qp); cp;)
+    {
+      auto const t(is_left(c));
+      auto const pp(t ? left_node(cp, c) : right_node(cp, c));
+
+      auto const so(size(t ? right_node(cp, pp) : left_node(cp, pp), cp));
+
+      if (auto const s(1 + sc + so); unbalanced<A>(s, sc, so))
+      {
+        auto const d(is_left(cp));
+
+        if (auto const nn(rebalance(cp, pp, q, qp, s, sb)); pp)
+        {
+          d ? (pp->l_ ^= conv(cp, nn), nn->l_ |= 1) : pp->r_ ^= conv(cp, nn);
+        }
+        else
+        {
+          r = nn;
+        }
+
+        break;
+      }
+      else
+      {
+        sc = s; assign(c, cp)(cp, pp);
+      }
+    }
+  }
+
+  return std::tuple(q, qp, true);
+}
+
+template <class A>
+inline void insert_batch_sorted(auto& r0, size_type const sz,
+  auto const& sb, auto const i, decltype(i) j, auto const& key,
+  auto const& create_node, auto const& append)
+{ // merge the sorted range [i, j) into the nonempty tree r0, of at most sz
+  // nodes afterwards, by descending with subranges, that are partitioned
+  // at every node visited, the keys meeting at a null link form a
+  // perfectly balanced subtree, append(n, v) receives values with a key
+  // equal to that of node n
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+  using iterator = std::remove_const_t<decltype(i)>;
+
+  struct S
+  {
+    decltype(r0) r_;
+    decltype(sb) sb_;
+    decltype(key) key_;
+    decltype(create_node) create_node_;
+    decltype(append) append_;
+
+    size_type const h_;
+    size_type c_{}; // created nodes
+
+    void count(node_t* const n, size_type const c) const noexcept
+    { // account for the nodes, created in the subtree of n
+      if constexpr(Counted<node_t>) n->s_ += c_ - c;
+    }
+
+    void link(node_t* const n, node_t* const x, decltype(node_t::r_)& c,
+      size_type const k, bool const t) noexcept
+    { // build the k chained nodes, x being any of them, below n
+      if (k)
+      {
+        node_t* qp;
+        auto const q(build(n, x, c, k, {}, qp, [](auto, auto, auto)
+          noexcept {}));
+
+        t ? (n->l_ ^= conv(q), q->l_ |= 1) : n->r_ ^= conv(q);
+
+        c_ += k;
+      }
+    }
+
+    size_type attach(node_t* const n, iterator a, iterator const b,
+      size_type const h, bool const t)
+    { // the null link of n, at depth h, receives the subrange [a, b)
+      decltype(n->r_) c;
+      auto l(&c);
+
+      node_t* x{};
+      size_type k{};
+
+      try
+      {
+        for (; a != b; ++a)
+        {
+          auto&& v(*a);
+
+          if (x && (node_t::cmp(key_(v), x->key()) == 0))
+          {
+            append_(x, std::forward<decltype(v)>(v));
+          }
+          else
+          {
+            *l = conv(x = create_node_(std::forward<decltype(v)>(v)));
+            l = &x->r_; ++k;
+          }
+        }
+      }
+      catch (...)
+      {
+        link(n, x, c, k, t);
+
+        throw;
+      }
+
+      link(n, x, c, k, t);
+
+      return h + std::bit_width(k) > h_ ? k : 0; // too deep?
+    }
+
+    // returns the size of the subtree rooted at n, while searching for a
+    // scapegoat, 0 otherwise
+    size_type operator()(node_t* const n, node_t* const p, iterator const a,
+      iterator const b, size_type const h)
+    {
+      auto const& k(n->key());
+
+      auto const lo(std::partition_point(a, b, [&](auto const& v) noexcept
+          {
+            return node_t::cmp(key_(v), k) < 0;
+          }
+        )
+      );
+
+      auto const hi(std::partition_point(lo, b, [&](auto const& v) noexcept
+          {
+            return node_t::cmp(key_(v), k) <= 0;
+          }
+        )
+      );
+
+      auto const c(c_);
+      size_type sl{}, sr{};
+
+      try
+      { // in order, so that a throw leaves a prefix of [a, b) merged in
+        if (a != lo)
+        {
+          auto const l(left_node(n, p));
+          sl = l ? (*this)(l, n, a, lo, h + 1) : attach(n, a, lo, h, true);
+        }
+
+        for (auto e(lo); e != hi; ++e)
+        {
+          auto&& v(*e);
+          append_(n, std::forward<decltype(v)>(v));
+        }
+
+        if (hi != b)
+        {
+          auto const r(right_node(n, p));
+          sr = r ? (*this)(r, n, hi, b, h + 1) : attach(n, hi, b, h, false);
+        }
+      }
+      catch (...)
+      {
+        count(n, c);
+
+        throw;
+      }
+
+      count(n, c);
+
+      if (!sl && !sr) return {};
+
+      if (!sl) sl = size(left_node(n, p), n);
+      if (!sr) sr = size(right_node(n, p), n);
+
+      if (auto const s(1 + sl + sr); unbalanced<A>(s, sl, sr))
+      {
+        auto const t(is_left(n));
+
+        if (node_t* qp; p)
+        {
+          auto const nn(rebalance(n, p, {}, qp, s, sb_));
+
+          t ? (p->l_ ^= conv(n, nn), nn->l_ |= 1) : p->r_ ^= conv(n, nn);
+        }
+        else
+        {
+          r_ = rebalance(n, p, {}, qp, s, sb_);
+        }
+
+        return {};
+      }
+      else
+      {
+        return s;
+      }
+    }
+  };
+
+  //
+  if (i != j) S{r0, sb, key, create_node, append, max_depth<A>(sz)}(r0, {},
+    i, j, {});
+}
+
+inline auto sort_chain(auto& h, size_type const n, auto const x)
+  -> std::remove_reference_t<decltype(h)>
+{ // detach the first n > 0 nodes of the chain h, return them as a stably
+  // sorted chain, x is any node of the pool; should a comparison throw, the
+  // n nodes are chained back in front of h
+  using node_t = std::remove_pointer_t<decltype(x)>;
+
+  if (1 == n)
+  {
+    auto const r(h);
+    h = node_of(x, h)->r_;
+
+    return r;
+  }
+  else
+  {
+    std::remove_cvref_t<decltype(h)> a, b, r;
+    auto t(&r);
+
+    size_type i{}, j{}; // nodes left in a and b
+
+    try
+    {
+      a = sort_chain(h, n / 2, x); i = n / 2;
+      b = sort_chain(h, n - i, x); j = n - i;
+
+      while (i || j)
+      {
+        auto const pa(i ? node_of(x, a) : nullptr),
+          pb(j ? node_of(x, b) : nullptr);
+
+        if (!pa || (pb && (node_t::cmp(pb->key(), pa->key()) < 0)))
+        {
+          *t = b; t = &pb->r_; b = pb->r_; --j;
+        }
+        else
+        {
+          *t = a; t = &pa->r_; a = pa->r_; --i;
+        }
+      }
+    }
+    catch (...)
+    {
+      for (; i; --i) *t = a, a = *(t = &node_of(x, a)->r_);
+      for (; j; --j) *t = b, b = *(t = &node_of(x, b)->r_);
+
+      *t = h; h = r;
+
+      throw;
+    }
+
+    return r;
+  }
 }
 
-inline auto rebalance(auto const n, decltype(n) p,
-  decltype(n) q, auto& qp, size_type const sz) noexcept
-{
-  using node_t = std::remove_pointer_t<std::remove_const_t<decltype(n)>>;
+inline void insert_sorted(auto& r0, auto const& na, auto i,
+  decltype(i) const j, auto const& key, auto const& create_node,
+  auto const& append, auto const& f)
+{ // merge the sorted range [i, j) with the tree in O(n + m), then build a
+  // perfectly balanced tree, append(n, v) receives values with a key equal
+  // to that of node n
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+
+  decltype(r0->r_) h, a; // output chain, chain of the existing nodes
+  auto t(&h);
+
+  node_t* n{}; // last node chained
+  node_t* an{}; // next existing node
+
+  auto m(na.size()); // existing nodes left
+
+  if (r0)
+  {
+    auto ta(&a);
+    flatten(r0, {}, ta);
+
+    an = node_of(r0, a);
+  }
+
+  auto const chain([&](node_t* const c) noexcept
+    {
+      *t = conv(n = c); t = &c->r_;
+    }
+  );
+
+  auto const chain_existing([&]() noexcept
+    {
+      chain(an); an = --m ? node_of(an, an->r_) : nullptr;
+    }
+  );
+
+  try
+  {
+    for (; i != j; ++i)
+    {
+      auto&& v(*i);
+      auto const& k(key(v));
+
+      while (an && (node_t::cmp(k, an->key()) > 0)) chain_existing();
+
+      if (n && (node_t::cmp(k, n->key()) == 0))
+      {
+        append(n, std::forward<decltype(v)>(v));
+      }
+      else if (an && (node_t::cmp(k, an->key()) == 0))
+      {
+        chain_existing(); append(n, std::forward<decltype(v)>(v));
+      }
+      else
+      {
+        chain(create_node(std::forward<decltype(v)>(v)));
+      }
+    }
+  }
+  catch (...)
+  { // the existing nodes left follow the chain, keep what was merged
+    if (an) *t = conv(an);
+
+    if (node_t* qp; n || an)
+    {
+      r0 = build(decltype(n){}, n ? n : an, h, na.size(), {}, qp, f);
+    }
+
+    throw;
+  }
+
+  while (an) chain_existing();
+
+  if (node_t* qp; n)
+  {
+    r0 = build(decltype(n){}, n, h, na.size(), {}, qp, f);
+  }
+}
 
-  auto const a(static_cast<node_t**>(XSG_ALLOCA(sizeof(node_t*) * sz)));
+inline void erase_range(auto& r0, auto& na, auto const& below,
+  auto const& above, auto const& f) noexcept
+{ // destroy the nodes n, for which neither below(n) nor above(n) holds,
+  // they must form an in-order range, the boundary paths are trimmed and
+  // the range is freed in O(h + k), f(n, l, r) sees every relinked node
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
 
   struct S
   {
-    std::remove_const_t<decltype(a)> b_;
+    decltype(na) na_;
+    decltype(below) b_;
+    decltype(above) a_;
+    decltype(f) f_;
+
+    static auto reparent(node_t* const c, node_t* const p, node_t* const q,
+      bool const t) noexcept
+    { // c, a child of p, becomes a child of q, a left child, if t
+      if (c)
+      {
+        auto const l(left_node(c, p)), r(right_node(c, p));
+
+        c->l_ = conv(l, q) | t; c->r_ = conv(r, q);
+      }
+
+      return c;
+    }
+
+    void relink(node_t* const n, node_t* const l, node_t* const r,
+      node_t* const q, bool const t) const noexcept
+    { // l and r are children of n, that becomes a child of q
+      n->l_ = conv(l, q) | t; n->r_ = conv(r, q);
 
-    void operator()(decltype(n) n, decltype(n) p) noexcept
+      reweigh(n, l, r); f_(n, l, r);
+    }
+
+    void drop(node_t* const n, node_t* const p) const noexcept
     {
       if (n)
       {
-        operator()(detail::left_node(n, p), n);
+        auto const l(left_node(n, p)), r(right_node(n, p));
+
+        drop(l, n); drop(r, n); na_.destroy(n);
+      }
+    }
+
+    std::pair<node_t*, node_t*> pop_first(node_t* const n,
+      node_t* const p) const noexcept
+    { // detach the first node of the subtree n, return it and the new root
+      auto const l(left_node(n, p)), r(right_node(n, p));
+
+      if (l)
+      {
+        auto const [m, nl](pop_first(l, n));
 
-        *b_++ = n;
+        relink(n, nl, r, p, is_left(n));
 
-        operator()(detail::right_node(n, p), n);
+        return {m, n};
+      }
+      else
+      {
+        return {n, reparent(r, n, p, is_left(n))};
       }
     }
-  };
 
-  struct T
-  {
-    decltype(q) q_;
-    decltype(qp) qp_;
+    node_t* lower(node_t* const n, node_t* const p, node_t* const q,
+      bool const t) const noexcept
+    { // keep the nodes below the range, the result becomes a child of q
+      if (!n) return n;
 
-    node_t* f(decltype(p) p, decltype(a) a, decltype(a) b) const noexcept
-    {
-      node_t* n;
+      auto const l(left_node(n, p)), r(right_node(n, p));
 
-      if (b == a)
+      if (b_(n))
       {
-        if ((n = *a) == q_) qp_ = p;
+        relink(n, l, lower(r, n, n, false), q, t);
+
+        return n;
+      }
+      else
+      { // n and its right subtree go
+        drop(r, n);
+
+        auto const c(lower(l, n, q, t));
+        na_.destroy(n);
 
-        detail::assign(n->l_, n->r_)(detail::conv(p), detail::conv(p));
+        return c;
       }
-      else if (b == a + 1)
-      { // n - nb
-        auto const nb(*b);
+    }
+
+    node_t* upper(node_t* const n, node_t* const p, node_t* const q,
+      bool const t) const noexcept
+    { // keep the nodes above the range, the result becomes a child of q
+      if (!n) return n;
 
-        if ((n = *a) == q_) qp_ = p; else if (nb == q_) qp_ = n;
+      auto const l(left_node(n, p)), r(right_node(n, p));
 
-        detail::assign(nb->l_, nb->r_, n->l_, n->r_)(detail::conv(n),
-          detail::conv(n), detail::conv(p), detail::conv(p, nb));
+      if (a_(n))
+      {
+        relink(n, upper(l, n, n, true), r, q, t);
+
+        return n;
       }
       else
+      { // n and its left subtree go
+        drop(l, n);
+
+        auto const c(upper(r, n, q, t));
+        na_.destroy(n);
+
+        return c;
+      }
+    }
+
+    node_t* trim(node_t* const n, node_t* const p, node_t* const q,
+      bool const t) const noexcept
+    {
+      if (!n) return n;
+
+      auto const l(left_node(n, p)), r(right_node(n, p));
+
+      if (b_(n))
+      {
+        relink(n, l, trim(r, n, n, false), q, t);
+      }
+      else if (a_(n))
       {
-        auto const m(std::midpoint(a, b));
+        relink(n, trim(l, n, n, true), r, q, t);
+      }
+      else
+      { // the range splits here, join what is left of the subtrees of n
+        auto const nl(lower(l, n, n, true)), nr(upper(r, n, n, false));
+
+        na_.destroy(n);
+
+        if (!nl || !nr)
+        {
+          return reparent(nl ? nl : nr, n, q, t);
+        }
+        else
+        { // the first node of nr takes the place of n
+          auto const [m, mr](pop_first(nr, n));
 
-        if ((n = *m) == q_) qp_ = p;
+          relink(m, reparent(nl, n, m, true), reparent(mr, n, m, false), q,
+            t);
 
-        detail::assign(n->l_, n->r_)(
-          detail::conv(f(n, a, m - 1), p),
-          detail::conv(f(n, m + 1, b), p)
-        );
+          return m;
+        }
       }
 
       return n;
     }
   };
 
-  S s{a}; s(n, p);
-
-  return T{q, qp}.f(p, a, s.b_ - 1);
+  r0 = S{na, below, above, f}.trim(r0, {}, {}, false);
 }
 
-inline auto emplace(auto& r, auto const& k, auto const& create_node)
-  noexcept(noexcept(create_node({})))
-{
-  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r)>>;
+inline void erase_if(auto& r0, auto& na, auto const& g, auto const& f)
+{ // destroy the nodes n, for which g(n) holds, in a single in-order pass,
+  // then rebuild the tree once
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+
+  if (!r0) return;
+
+  decltype(r0->r_) h, o; // input chain, chain of the kept nodes
+  auto t(&o);
 
-  struct S
   {
-    enum Direction: bool { LEFT, RIGHT };
+    auto t(&h);
+    flatten(r0, {}, t);
+  }
 
-    decltype(r) r_;
-    decltype(k) k_;
-    decltype(create_node) create_node_;
+  auto const x(r0);
+  node_t* y{}; // any kept node
+  size_type k{}; // kept nodes
 
-    node_t* q_, *qp_;
-    bool s_;
+  auto c(h);
+
+  for (auto i(na.size()); i; --i)
+  {
+    auto const n(node_of(x, c));
+    c = n->r_;
 
-    explicit S(decltype(r) r, decltype(k) k,
-      decltype(create_node) cn) noexcept:
-      r_(r), k_(k), create_node_(cn)
+    bool d;
+
+    try
     {
+      d = g(n);
+    }
+    catch (...)
+    { // keep n and the nodes after it
+      *t = conv(n);
+
+      node_t* qp;
+      r0 = build(decltype(x){}, n, o, k + i, {}, qp, f);
+
+      throw;
     }
 
-    size_type operator()(node_t* n, decltype(n) p, enum Direction const d)
-      noexcept(noexcept(create_node_({})))
+    if (d)
     {
-      size_type sl, sr;
+      na.destroy(n);
+    }
+    else
+    {
+      *t = conv(y = n); t = &n->r_; ++k;
+    }
+  }
 
-      if (auto const c(node_t::cmp(k_, n->key())); c < 0)
+  node_t* qp;
+  r0 = k ? build(decltype(x){}, y, o, k, {}, qp, f) : nullptr;
+}
+
+inline bool split(auto& r0, auto& na, decltype(r0) r1, auto& na1,
+  auto const& k, auto const& create_node)
+{ // move the nodes with keys not less than k into the empty tree r1, the
+  // smaller part is relocated into na1 with create_node(n), unless it
+  // returns n, as na1 shares na's nodes, if it is the left part, the trees
+  // end up swapped and true is returned, both parts must be nonempty
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+
+  auto const sz(na.size());
+
+  decltype(r0->r_) h;
+
+  {
+    auto t(&h);
+    flatten(r0, {}, t);
+  }
+
+  auto const x(r0); // any node of the chain
+  auto b(&h); // link to the first node with a key not less than k
+  size_type l{}; // nodes with keys less than k
+
+  for (; node_t::cmp(node_of(x, *b)->key(), k) < 0; ++l)
+  {
+    b = &node_of(x, *b)->r_;
+  }
+
+  auto const t(l <= sz - l); // relocate the left part?
+  auto const s(t ? l : sz - l);
+  auto const c(t ? h : *b); // the chain to relocate
+
+  decltype(r0->r_) h1;
+  node_t* x1{};
+  bool m{}; // moved, not relocated?
+
+  {
+    auto t1(&h1);
+    size_type i{};
+
+    try
+    {
+      for (auto n(c); i != s; ++i)
+      { // a moved node is rechained in place
+        auto const p(node_of(x, n)), q(create_node(p));
+
+        n = p->r_; m = p == q; *t1 = conv(x1 = q); t1 = &q->r_;
+      }
+    }
+    catch (...)
+    { // drop the copies, restore the tree
+      for (auto n(h1); i; --i)
       {
-        if (auto const l = left_node(n, p))
-        {
-          if (!(sl = (*this)(l, n, LEFT))) return {};
-        }
-        else
-        {
-          assign(sl, q_, qp_, s_)(1, create_node_(n), n, true);
-          n->l_ = conv(q_, p);
-        }
+        auto const q(node_of(x1, n));
 
-        sr = size(right_node(n, p), n);
+        n = q->r_; na1.destroy(q);
+      }
+
+      node_t* qp;
+      r0 = build(decltype(x){}, x, h, sz, {}, qp, [](auto, auto, auto)
+        noexcept {});
+
+      throw;
+    }
+  }
+
+  auto kh(t ? *b : h); // the chain to keep
+  auto const y(node_of(x, kh));
+
+  for (auto n(c), i(s); i; --i)
+  {
+    auto const p(node_of(x, n));
+
+    n = p->r_; m ? na.detach(p), na1.attach(p) : na.destroy(p);
+  }
+
+  node_t* qp;
+  r1 = build(decltype(x){}, x1, h1, s, {}, qp, [](auto, auto, auto)
+    noexcept {});
+  r0 = build(decltype(x){}, y, kh, sz - s, {}, qp, [](auto, auto, auto)
+    noexcept {});
+
+  return t;
+}
+
+inline auto join(auto& na, auto const l, decltype(l) r, auto& na1,
+  auto const& sb)
+{ // the keys of the tree l precede those of the tree r, na adopts the
+  // nodes of na1 and both trees are rebuilt as one
+  using node_t = std::remove_pointer_t<std::remove_const_t<decltype(l)>>;
+
+  auto const sz(na.size() + na1.size());
+
+  std::unique_ptr<node_t*[]> t;
+  auto const a(sz <= sb.n_ ? sb.a_.get() : (t.reset(new node_t*[sz]),
+    t.get()));
+
+  gather(r, {}, gather(l, {}, a));
+
+  na.adopt(na1); // indexed links are stale from here on
+
+  node_t* qp;
+  return build(decltype(l){}, a, a + sz - 1, {}, qp, [](auto, auto, auto)
+    noexcept {});
+}
+
+inline void merge(auto& r0, auto& na, decltype(r0) r1, auto& na1,
+  auto const& sb, auto const& create_node)
+{ // move the nodes of the nonempty tree r1, whose keys are not in r0, into
+  // r0, relocating them into na with create_node(n), unless it returns n,
+  // as na shares na1's chunks, r1 keeps the rest
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+
+  auto const sz(na.size() + na1.size()); // upper bound of the result size
+
+  std::unique_ptr<node_t*[]> t;
+  auto const a(sz <= sb.n_ ? sb.a_.get() : (t.reset(new node_t*[sz]),
+    t.get()));
+  auto w(a);
+
+  decltype(r0->r_) ha, hb, hc; // hc chains the nodes r1 keeps
+  auto tc(&hc);
+  node_t* an{}, *bn{};
+  auto const x(r0), y(r1); // any node of either tree
+  size_type i(na.size()), j(na1.size()), k{};
+
+  if (r0)
+  {
+    auto t(&ha);
+    flatten(r0, {}, t);
+
+    an = node_of(x, ha);
+  }
+
+  {
+    auto t(&hb);
+    flatten(r1, {}, t);
+
+    bn = node_of(y, hb);
+  }
+
+  auto const next_a([&]() noexcept
+    {
+      auto const c(an); an = --i ? node_of(x, c->r_) : nullptr; return c;
+    }
+  );
+
+  auto const next_b([&]() noexcept
+    {
+      auto const c(bn); bn = --j ? node_of(y, c->r_) : nullptr; return c;
+    }
+  );
+
+  auto const move_b([&]()
+    { // bn stays in r1, should create_node() throw
+      auto const c(create_node(bn)), b(next_b());
+
+      if (*w++ = c; c == b) na1.detach(b), na.attach(b); else na1.destroy(b);
+    }
+  );
+
+  node_t* qp;
+
+  try
+  {
+    while (an && bn)
+    {
+      if (auto const c(node_t::cmp(an->key(), bn->key())); c < 0)
+      {
+        *w++ = next_a();
       }
       else if (c > 0)
       {
-        if (auto const r = right_node(n, p))
-        {
-          if (!(sr = ((*this)(r, n, RIGHT)))) return {};
-        }
-        else
-        {
-          assign(sr, q_, qp_, s_)(1, create_node_(n), n, true);
-          n->r_ = conv(q_, p);
-        }
-
-        sl = size(left_node(n, p), n);
+        move_b();
       }
-      else [[unlikely]]
+      else
       {
-        assign(q_, qp_, s_)(n, p, false);
+        *w++ = next_a();
 
-        return {};
+        auto const b(next_b()); *tc = conv(b); tc = &b->r_; ++k;
       }
+    }
 
-      //
-      if (auto const s(1 + sl + sr), S(2 * s);
-        (3 * sl > S) || (3 * sr > S))
+    while (bn) move_b();
+  }
+  catch (...)
+  { // r0 keeps its nodes and those moved so far, r1 the rest
+    while (an) *w++ = next_a();
+
+    if (bn) *tc = conv(bn), k += j;
+
+    r0 = a == w ? nullptr : build(decltype(x){}, a, w - 1, {}, qp,
+      [](auto, auto, auto) noexcept {});
+    r1 = build(decltype(x){}, y, hc, k, {}, qp, [](auto, auto, auto)
+      noexcept {});
+
+    throw;
+  }
+
+  while (an) *w++ = next_a();
+
+  r0 = build(decltype(x){}, a, w - 1, {}, qp, [](auto, auto, auto)
+    noexcept {});
+  r1 = build(decltype(x){}, y, hc, k, {}, qp, [](auto, auto, auto)
+    noexcept {});
+}
+
+template <bool A, bool AB, bool B>
+inline void combine(auto& r0, auto& na, auto& r1, size_type const m,
+  auto* const na1, auto const& sb, auto const& create_node)
+{ // merge the tree r1 of m nodes with r0 in order, keeping the nodes found
+  // only in r0 (A), in both trees (AB, r0's node is kept) and only in r1
+  // (B), if na1 is not null, r1's nodes are moved and na adopts na1,
+  // otherwise the kept nodes of r1 are copied with create_node(n), should
+  // the merge throw, r0 is rebuilt from its nodes left and those merged so
+  // far, while moved nodes go back to r1
+  using node_t = std::remove_pointer_t<std::remove_reference_t<decltype(r0)>>;
+
+  auto const sz(na.size() + (B ? m : 0)); // upper bound of the result size
+
+  if (!sz) return;
+
+  std::unique_ptr<node_t*[]> t;
+  auto const a(sz <= sb.n_ ? sb.a_.get() : (t.reset(new node_t*[sz]),
+    t.get()));
+  auto w(a);
+
+  if (na1) na.reserve(*na1); // adopting na1 will not throw
+
+  decltype(r0->r_) ha, hb;
+  node_t* an{}, *bn{}, *bp{};
+  auto const x(r0), y(r1); // any node of either tree
+  size_type i(na.size()), j(m);
+
+  if (r0)
+  {
+    auto t(&ha);
+    flatten(r0, {}, t);
+
+    an = node_of(x, ha);
+  }
+
+  if (!r1)
+  {
+  }
+  else if (na1)
+  {
+    auto t(&hb);
+    flatten(r1, {}, t);
+
+    bn = node_of(y, hb);
+  }
+  else
+  { // r1 is only read
+    std::tie(bn, bp) = first_node(r1, {});
+  }
+
+  auto const next_a([&]() noexcept
+    {
+      auto const c(an); an = --i ? node_of(x, c->r_) : nullptr; return c;
+    }
+  );
+
+  auto const next_b([&]() noexcept
+    {
+      auto const c(bn);
+
+      if (!--j)
       {
-        if (auto const nn(rebalance(n, p, q_, qp_, s)); p)
-        {
-          d ? p->r_ = conv(nn, right_node(p, n)) :
-            p->l_ = conv(nn, left_node(p, n));
-        }
-        else
-        {
-          r_ = nn;
-        }
+        bn = {};
+      }
+      else if (na1)
+      {
+        bn = node_of(y, c->r_);
+      }
+      else
+      {
+        std::tie(bn, bp) = next_node(bn, bp);
+      }
 
-        return {};
+      return c;
+    }
+  );
+
+  auto const keep_a([&]() noexcept
+    { // the l_ links tell moved nodes apart, until the build
+      auto const c(next_a()); if (na1) c->l_ = {}; *w++ = c;
+    }
+  );
+
+  auto const drop_b([&](node_t* const c) noexcept
+    {
+      if (na1) na1->destroy(c);
+    }
+  );
+
+  auto const keep_b([&](node_t* const c)
+    {
+      if (na1) c->l_ = 1, *w++ = c; else *w++ = create_node(c);
+    }
+  );
+
+  node_t* qp;
+
+  try
+  {
+    while (an && bn)
+    {
+      if (auto const c(node_t::cmp(an->key(), bn->key())); c < 0)
+      {
+        A ? keep_a() : na.destroy(next_a());
+      }
+      else if (c > 0)
+      {
+        B ? keep_b(next_b()) : drop_b(next_b());
       }
       else
       {
-        return s;
+        AB ? keep_a() : na.destroy(next_a());
+        drop_b(next_b());
       }
     }
-  };
 
-  //
-  S s(r, k, create_node); s(r, {}, {});
+    while (an) A ? keep_a() : na.destroy(next_a());
+    while (bn && (B || na1)) B ? keep_b(next_b()) : drop_b(next_b());
+  }
+  catch (...)
+  {
+    while (an) keep_a();
+
+    if constexpr(!std::is_const_v<std::remove_reference_t<decltype(r1)>>)
+    {
+      if (na1)
+      { // the moved nodes go back to r1, followed by its nodes left
+        decltype(r0->r_) h;
+        auto t(&h);
+        auto v(a);
+
+        for (auto u(a); u != w; ++u)
+        {
+          if (auto const c(*u); c->l_) *t = conv(c), t = &c->r_, ++j;
+          else *v++ = c;
+        }
+
+        if (bn) *t = conv(bn);
+
+        w = v;
+        r1 = build(decltype(x){}, y, h, j, {}, qp, [](auto, auto, auto)
+          noexcept {});
+      }
+    }
+
+    r0 = a == w ? nullptr : build(decltype(x){}, a, w - 1, {}, qp,
+      [](auto, auto, auto) noexcept {});
+
+    throw;
+  }
+
+  if (na1) na.adopt(*na1); // indexed links are stale from here on
+
+  r0 = a == w ? nullptr : build(decltype(x){}, a, w - 1, {}, qp,
+    [](auto, auto, auto) noexcept {});
+}
 
-  return std::tuple(s.q_, s.qp_, s.s_);
 }
 
+namespace xsg
+{
+
+struct sorted_t { explicit sorted_t() = default; };
+inline constexpr sorted_t sorted{}; // the input range is sorted
+
 }
 
 #endif // XSG_UTILS_HPP